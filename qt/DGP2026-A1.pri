@@ -17,7 +17,11 @@ UTIL_DIR = $$SOURCEDIR/util
 WRL_DIR  = $$SOURCEDIR/wrl
 
 SOURCES += \
+	$$SOURCEDIR/core/Edges.cpp \
 	$$SOURCEDIR/core/Faces.cpp \
+	$$SOURCEDIR/core/HalfEdges.cpp \
+	$$SOURCEDIR/core/TriangleNormals.cpp \
+	$$SOURCEDIR/core/VertexWeld.cpp \
 	$$SOURCEDIR/gui/GuiAboutDialog.cpp \
 	$$SOURCEDIR/gui/GuiGLBuffer.cpp \
 	$$SOURCEDIR/gui/GuiGLHandles.cpp \
@@ -30,15 +34,21 @@ SOURCES += \
 	$$SOURCEDIR/gui/GuiViewerData.cpp \
 	$$SOURCEDIR/io/AppLoader.cpp \
 	$$SOURCEDIR/io/AppSaver.cpp \
+	$$SOURCEDIR/io/FileMap.cpp \
 	$$SOURCEDIR/io/LoaderStl.cpp \
+	$$SOURCEDIR/io/LoaderWrb.cpp \
 	$$SOURCEDIR/io/LoaderWrl.cpp \
 	$$SOURCEDIR/io/SaverStl.cpp \
+	$$SOURCEDIR/io/SaverWrb.cpp \
 	$$SOURCEDIR/io/SaverWrl.cpp \
 	$$SOURCEDIR/io/Tokenizer.cpp \
+	$$SOURCEDIR/io/TokenizerBuffer.cpp \
 	$$SOURCEDIR/io/TokenizerFile.cpp \
 	$$SOURCEDIR/io/TokenizerString.cpp \
 	$$SOURCEDIR/util/BBox.cpp \
+	$$SOURCEDIR/util/MinMax.cpp \
 	$$SOURCEDIR/util/StaticRotation.cpp \
+	$$SOURCEDIR/util/ThreadPool.cpp \
 	$$SOURCEDIR/wrl/Appearance.cpp \
 	$$SOURCEDIR/wrl/Group.cpp \
 	$$SOURCEDIR/wrl/ImageTexture.cpp \
@@ -56,7 +66,11 @@ SOURCES += \
         $$(NULL)
 
 HEADERS += \
+	$$SOURCEDIR/core/Edges.hpp \
 	$$SOURCEDIR/core/Faces.hpp \
+	$$SOURCEDIR/core/HalfEdges.hpp \
+	$$SOURCEDIR/core/TriangleNormals.hpp \
+	$$SOURCEDIR/core/VertexWeld.hpp \
 	$$SOURCEDIR/gui/GuiAboutDialog.hpp \
 	$$SOURCEDIR/gui/GuiGLBuffer.hpp \
 	$$SOURCEDIR/gui/GuiGLHandles.hpp \
@@ -69,18 +83,25 @@ HEADERS += \
 	$$SOURCEDIR/gui/GuiViewerData.hpp \
 	$$SOURCEDIR/io/AppLoader.hpp \
 	$$SOURCEDIR/io/AppSaver.hpp \
+	$$SOURCEDIR/io/FileMap.hpp \
 	$$SOURCEDIR/io/Loader.hpp \
 	$$SOURCEDIR/io/LoaderStl.hpp \
+	$$SOURCEDIR/io/LoaderWrb.hpp \
 	$$SOURCEDIR/io/LoaderWrl.hpp \
 	$$SOURCEDIR/io/Saver.hpp \
 	$$SOURCEDIR/io/SaverStl.hpp \
+	$$SOURCEDIR/io/SaverWrb.hpp \
 	$$SOURCEDIR/io/SaverWrl.hpp \
 	$$SOURCEDIR/io/StrException.hpp \
 	$$SOURCEDIR/io/Tokenizer.hpp \
+	$$SOURCEDIR/io/TokenizerBuffer.hpp \
 	$$SOURCEDIR/io/TokenizerFile.hpp \
 	$$SOURCEDIR/io/TokenizerString.hpp \
+	$$SOURCEDIR/io/WrbFormat.hpp \
 	$$SOURCEDIR/util/BBox.hpp \
+	$$SOURCEDIR/util/MinMax.hpp \
 	$$SOURCEDIR/util/StaticRotation.hpp \
+	$$SOURCEDIR/util/ThreadPool.hpp \
 	$$SOURCEDIR/wrl/Appearance.hpp \
 	$$SOURCEDIR/wrl/Group.hpp \
 	$$SOURCEDIR/wrl/ImageTexture.hpp \
@@ -0,0 +1,153 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// Edges.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Edges.hpp"
+
+Edges::Edges(const int nV, const vector<int>& coordIndex):
+  _nV((nV>0)?nV:0),
+  _cornerEdge(coordIndex.size(),-1) {
+
+  int nC = (int)coordIndex.size();
+  int iC,i0,i1,iV,iV0,iV1,iE,nE;
+
+  for(iC=0;iC<nC;iC++)
+    if((iV=coordIndex[iC])>=_nV) _nV = iV+1;
+
+  // count the face boundary segments by smallest vertex index
+  vector<int> bucket(_nV+1,0);
+  for(i0=i1=0;i1<=nC;i1++) {
+    if(i1<nC && coordIndex[i1]>=0) continue;
+    for(iC=i0;iC<i1;iC++) {
+      iV0 = coordIndex[iC];
+      iV1 = coordIndex[(iC+1<i1)?iC+1:i0];
+      if(iV0!=iV1) bucket[((iV0<iV1)?iV0:iV1)+1]++;
+    }
+    i0 = i1+1;
+  }
+  for(iV=0;iV<_nV;iV++)
+    bucket[iV+1] += bucket[iV];
+
+  // sort the corners which start each segment into the buckets
+  vector<int> order(bucket[_nV]);
+  vector<int> other(bucket[_nV]);
+  vector<int> next(bucket.begin(),bucket.end()-1);
+  for(i0=i1=0;i1<=nC;i1++) {
+    if(i1<nC && coordIndex[i1]>=0) continue;
+    for(iC=i0;iC<i1;iC++) {
+      iV0 = coordIndex[iC];
+      iV1 = coordIndex[(iC+1<i1)?iC+1:i0];
+      if(iV0<iV1) {
+        other[next[iV0]] = iV1; order[next[iV0]++] = iC;
+      } else if(iV1<iV0) {
+        other[next[iV1]] = iV0; order[next[iV1]++] = iC;
+      }
+    }
+    i0 = i1+1;
+  }
+
+  // match the segments within each bucket by largest vertex index;
+  // stamp[iV1]==iV0 marks that the edge (iV0,iV1) already exists
+  vector<int> stamp(_nV,-1);
+  vector<int> slot(_nV,-1);
+  _firstEdge.resize(_nV+1,0);
+  _vertex.reserve(bucket[_nV]);
+  for(nE=iV0=0;iV0<_nV;iV0++) {
+    _firstEdge[iV0] = nE;
+    for(int j=bucket[iV0];j<bucket[iV0+1];j++) {
+      iC  = order[j];
+      iV1 = other[j];
+      if(stamp[iV1]==iV0) {
+        iE = slot[iV1];
+      } else {
+        iE = nE++;
+        stamp[iV1] = iV0;
+        slot[iV1]  = iE;
+        _vertex.push_back(iV0);
+        _vertex.push_back(iV1);
+      }
+      _cornerEdge[iC] = iE;
+    }
+  }
+  _firstEdge[_nV] = nE;
+
+  // vertex to edge incidence
+  _vertexEdgeFirst.resize(_nV+1,0);
+  for(iE=0;iE<nE;iE++) {
+    _vertexEdgeFirst[_vertex[2*iE  ]+1]++;
+    _vertexEdgeFirst[_vertex[2*iE+1]+1]++;
+  }
+  for(iV=0;iV<_nV;iV++)
+    _vertexEdgeFirst[iV+1] += _vertexEdgeFirst[iV];
+  _vertexEdge.resize(2*nE);
+  next.assign(_vertexEdgeFirst.begin(),_vertexEdgeFirst.end()-1);
+  for(iE=0;iE<nE;iE++) {
+    _vertexEdge[next[_vertex[2*iE  ]]++] = iE;
+    _vertexEdge[next[_vertex[2*iE+1]]++] = iE;
+  }
+}
+
+int Edges::getNumberOfVertices() const {
+  return _nV;
+}
+
+int Edges::getNumberOfEdges() const {
+  return (int)(_vertex.size()/2);
+}
+
+int Edges::getVertex0(const int iE) const {
+  return (0<=iE && iE<getNumberOfEdges())?_vertex[2*iE  ]:-1;
+}
+
+int Edges::getVertex1(const int iE) const {
+  return (0<=iE && iE<getNumberOfEdges())?_vertex[2*iE+1]:-1;
+}
+
+int Edges::getEdge(const int iV0, const int iV1) const {
+  int v0 = (iV0<iV1)?iV0:iV1;
+  int v1 = (iV0<iV1)?iV1:iV0;
+  if(v0<0 || v1>=_nV || v0==v1) return -1;
+  for(int iE=_firstEdge[v0];iE<_firstEdge[v0+1];iE++)
+    if(_vertex[2*iE+1]==v1)
+      return iE;
+  return -1;
+}
+
+int Edges::getNumberOfVertexEdges(const int iV) const {
+  return (0<=iV && iV<_nV)?_vertexEdgeFirst[iV+1]-_vertexEdgeFirst[iV]:0;
+}
+
+int Edges::getVertexEdge(const int iV, const int j) const {
+  if(j<0 || j>=getNumberOfVertexEdges(iV)) return -1;
+  return _vertexEdge[_vertexEdgeFirst[iV]+j];
+}
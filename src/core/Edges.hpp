@@ -0,0 +1,91 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// Edges.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _EDGES_HPP_
+#define _EDGES_HPP_
+
+#include <vector>
+
+using namespace std;
+
+// Undirected graph of the edges of a polygon mesh. The edges are
+// extracted from the faces described by a coordIndex array, and are
+// identified by their two end vertices iV0<iV1. The construction
+// buckets the face boundary segments by their smallest vertex index
+// with a counting sort, so that it runs in time linear in the number
+// of corners and vertices. The edges are numbered by increasing iV0,
+// and the edges sharing the same iV0 in the order in which their
+// first segment appears in the coordIndex array; as a result, the
+// edge indices depend on the order of the faces.
+
+class Edges {
+
+public:
+
+          Edges(const int nV, const vector<int>& coordIndex);
+
+  // As in the Faces class, the number of vertices is the maximum of
+  // the nV value passed to the constructor and one plus the largest
+  // index found in the coordIndex array.
+  int     getNumberOfVertices()                     const;
+
+  int     getNumberOfEdges()                        const;
+
+  // If iE is a valid edge index, these methods return the smallest
+  // and the largest vertex indices of the edge. Otherwise they
+  // return -1.
+  int     getVertex0(const int iE)                  const;
+  int     getVertex1(const int iE)                  const;
+
+  // Returns the index of the edge joining vertices iV0 and iV1, in
+  // any order, or -1 if no such edge exists. The running time is
+  // proportional to the number of edges incident to min(iV0,iV1).
+  int     getEdge(const int iV0, const int iV1)     const;
+
+  // Edges incident to vertex iV, sorted by increasing edge index.
+  int     getNumberOfVertexEdges(const int iV)      const;
+  int     getVertexEdge(const int iV, const int j)  const;
+
+protected:
+
+  int         _nV;
+  vector<int> _vertex;          // [2*iE,2*iE+1] = (iV0,iV1)
+  vector<int> _firstEdge;       // edges with iV0==iV in [_firstEdge[iV],_firstEdge[iV+1])
+  vector<int> _vertexEdgeFirst; // CSR offsets of the vertex edges
+  vector<int> _vertexEdge;
+  vector<int> _cornerEdge;      // edge from corner iC to the next corner, or -1
+
+};
+
+#endif /* _EDGES_HPP_ */
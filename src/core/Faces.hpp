@@ -88,13 +88,18 @@ public:
   int     getNextCorner(const int iC)              const;
 
 private:
-  // TODO
-  std::vector<int> coordIndex_;
-  int num_vertices_;
-  int num_faces_;
-  int num_corners_;
-  std::vector<std::vector<int>> face_vertice_coordIndex_; 
-  std::vector<std::vector<int>> face_corners_coordIndex_; 
+
+  // Compressed row storage. The faces are stored as ranges of the
+  // coordIndex array: face iF occupies the corners
+  // [_faceFirst[iF],_faceFirst[iF]+_faceSize[iF]). The _cornerFace
+  // array maps each corner to its face, or to -1 for the separators,
+  // so that every accessor runs in constant time.
+
+  int         _nV;
+  vector<int> _coordIndex;
+  vector<int> _cornerFace;
+  vector<int> _faceFirst;
+  vector<int> _faceSize;
 
 };
 
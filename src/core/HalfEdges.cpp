@@ -0,0 +1,165 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// HalfEdges.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "HalfEdges.hpp"
+
+HalfEdges::HalfEdges(const int nV, const vector<int>& coordIndex):
+  Edges(nV,coordIndex),
+  _faces(nV,coordIndex),
+  _twin(coordIndex.size(),-1) {
+
+  int nC = (int)coordIndex.size();
+  int nE = getNumberOfEdges();
+  int iC,iE,iV,i,n;
+
+  // edge to half-edge incidence
+  _edgeFirst.resize(nE+1,0);
+  for(iC=0;iC<nC;iC++)
+    if((iE=_cornerEdge[iC])>=0)
+      _edgeFirst[iE+1]++;
+  for(iE=0;iE<nE;iE++)
+    _edgeFirst[iE+1] += _edgeFirst[iE];
+  _edgeHalfEdge.resize(_edgeFirst[nE]);
+  vector<int> next(_edgeFirst.begin(),_edgeFirst.end()-1);
+  for(iC=0;iC<nC;iC++)
+    if((iE=_cornerEdge[iC])>=0)
+      _edgeHalfEdge[next[iE]++] = iC;
+
+  // twins; the half-edges of singular edges are linked in a cycle
+  for(iE=0;iE<nE;iE++) {
+    i = _edgeFirst[iE];
+    n = _edgeFirst[iE+1]-i;
+    if(n<2) continue;
+    for(int j=0;j<n;j++)
+      _twin[_edgeHalfEdge[i+j]] = _edgeHalfEdge[i+(j+1)%n];
+  }
+
+  // vertex to corner incidence
+  _vertexFirst.resize(_nV+1,0);
+  for(iC=0;iC<nC;iC++)
+    if((iV=coordIndex[iC])>=0)
+      _vertexFirst[iV+1]++;
+  for(iV=0;iV<_nV;iV++)
+    _vertexFirst[iV+1] += _vertexFirst[iV];
+  _vertexCorner.resize(_vertexFirst[_nV]);
+  next.assign(_vertexFirst.begin(),_vertexFirst.end()-1);
+  for(iC=0;iC<nC;iC++)
+    if((iV=coordIndex[iC])>=0)
+      _vertexCorner[next[iV]++] = iC;
+}
+
+const Faces& HalfEdges::getFaces() const {
+  return _faces;
+}
+
+int HalfEdges::getNumberOfCorners() const {
+  return _faces.getNumberOfCorners();
+}
+
+int HalfEdges::getFace(const int iC) const {
+  return _faces.getCornerFace(iC);
+}
+
+int HalfEdges::getSrc(const int iC) const {
+  int iF = _faces.getCornerFace(iC);
+  if(iF<0) return -1;
+  return _faces.getFaceVertex(iF,iC-_faces.getFaceFirstCorner(iF));
+}
+
+int HalfEdges::getDst(const int iC) const {
+  return getSrc(_faces.getNextCorner(iC));
+}
+
+int HalfEdges::getNext(const int iC) const {
+  return _faces.getNextCorner(iC);
+}
+
+int HalfEdges::getPrev(const int iC) const {
+  int iF = _faces.getCornerFace(iC);
+  if(iF<0) return -1;
+  int i0 = _faces.getFaceFirstCorner(iF);
+  return (iC>i0)?iC-1:i0+_faces.getFaceSize(iF)-1;
+}
+
+int HalfEdges::getEdge(const int iC) const {
+  return (0<=iC && iC<(int)_cornerEdge.size())?_cornerEdge[iC]:-1;
+}
+
+int HalfEdges::getTwin(const int iC) const {
+  return (0<=iC && iC<(int)_twin.size())?_twin[iC]:-1;
+}
+
+int HalfEdges::getOpposite(const int iC) const {
+  int iT = getTwin(getNext(iC));
+  return (iT<0)?-1:getPrev(iT);
+}
+
+int HalfEdges::getNumberOfEdgeHalfEdges(const int iE) const {
+  if(iE<0 || iE>=getNumberOfEdges()) return 0;
+  return _edgeFirst[iE+1]-_edgeFirst[iE];
+}
+
+int HalfEdges::getEdgeHalfEdge(const int iE, const int j) const {
+  if(j<0 || j>=getNumberOfEdgeHalfEdges(iE)) return -1;
+  return _edgeHalfEdge[_edgeFirst[iE]+j];
+}
+
+bool HalfEdges::isBoundaryEdge(const int iE) const {
+  return getNumberOfEdgeHalfEdges(iE)==1;
+}
+
+bool HalfEdges::isRegularEdge(const int iE) const {
+  return getNumberOfEdgeHalfEdges(iE)==2;
+}
+
+bool HalfEdges::isSingularEdge(const int iE) const {
+  return getNumberOfEdgeHalfEdges(iE)>2;
+}
+
+bool HalfEdges::isBoundaryVertex(const int iV) const {
+  int n = getNumberOfVertexEdges(iV);
+  for(int j=0;j<n;j++)
+    if(isBoundaryEdge(getVertexEdge(iV,j)))
+      return true;
+  return false;
+}
+
+int HalfEdges::getNumberOfVertexCorners(const int iV) const {
+  return (0<=iV && iV<_nV)?_vertexFirst[iV+1]-_vertexFirst[iV]:0;
+}
+
+int HalfEdges::getVertexCorner(const int iV, const int j) const {
+  if(j<0 || j>=getNumberOfVertexCorners(iV)) return -1;
+  return _vertexCorner[_vertexFirst[iV]+j];
+}
@@ -0,0 +1,114 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// HalfEdges.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _HALF_EDGES_HPP_
+#define _HALF_EDGES_HPP_
+
+#include "Faces.hpp"
+#include "Edges.hpp"
+
+// Half-edge connectivity of a polygon mesh. Every corner iC of a face
+// is identified with the half-edge which goes from the vertex of iC
+// to the vertex of the next corner of the same face. As in the Faces
+// class, the -1 separators of the coordIndex array are also counted
+// as corners, but they have no face and no edge, and all the
+// accessors return -1 for them.
+//
+// Non-manifold meshes are supported. A regular edge has exactly two
+// half-edges, which are each other's twin. A boundary edge has one
+// half-edge, with no twin. The half-edges of a singular edge, with
+// three or more half-edges, are linked in a cycle by the getTwin()
+// method, so that every half-edge of the edge can be visited
+// starting from any one of them.
+
+class HalfEdges : public Edges {
+
+public:
+
+          HalfEdges(const int nV, const vector<int>& coordIndex);
+
+  using   Edges::getEdge;
+
+  const Faces& getFaces()                                const;
+
+  int     getNumberOfCorners()                           const;
+  int     getFace(const int iC)                          const;
+
+  // Source and destination vertices of the half-edge iC.
+  int     getSrc(const int iC)                           const;
+  int     getDst(const int iC)                           const;
+
+  // Next and previous corners within the face which contains iC.
+  int     getNext(const int iC)                          const;
+  int     getPrev(const int iC)                          const;
+
+  // Edge which contains the half-edge iC; -1 for separators and for
+  // degenerate half-edges with equal end vertices.
+  int     getEdge(const int iC)                          const;
+  int     getTwin(const int iC)                          const;
+
+  // For triangle meshes this is the opposite corner of the corner
+  // table representation: the corner of the neighboring triangle
+  // which faces the edge opposite to iC, or -1 if that edge is a
+  // boundary edge.
+  int     getOpposite(const int iC)                      const;
+
+  // Half-edges of the edge iE, sorted by increasing corner index.
+  int     getNumberOfEdgeHalfEdges(const int iE)         const;
+  int     getEdgeHalfEdge(const int iE, const int j)     const;
+
+  bool    isBoundaryEdge(const int iE)                   const;
+  bool    isRegularEdge(const int iE)                    const;
+  bool    isSingularEdge(const int iE)                   const;
+
+  // A vertex is a boundary vertex if any of its edges is a boundary
+  // edge.
+  bool    isBoundaryVertex(const int iV)                 const;
+
+  // Corners incident to vertex iV, sorted by increasing corner index.
+  int     getNumberOfVertexCorners(const int iV)         const;
+  int     getVertexCorner(const int iV, const int j)     const;
+
+private:
+
+  Faces       _faces;
+  vector<int> _twin;
+  vector<int> _edgeFirst;     // CSR offsets of the edge half-edges
+  vector<int> _edgeHalfEdge;
+  vector<int> _vertexFirst;   // CSR offsets of the vertex corners
+  vector<int> _vertexCorner;
+
+};
+
+#endif /* _HALF_EDGES_HPP_ */
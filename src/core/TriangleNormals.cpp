@@ -0,0 +1,325 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// TriangleNormals.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <math.h>
+#include "TriangleNormals.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define TRIANGLE_NORMALS_X86
+#include <immintrin.h>
+#if !defined(__clang__)
+// GCC would otherwise fuse the products and differences of the cross
+// products into FMA instructions, which AVX-512 implies
+#pragma GCC optimize("fp-contract=off")
+#endif
+#elif defined(_M_X64)
+#define TRIANGLE_NORMALS_SSE2_ONLY
+#include <emmintrin.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////
+// scalar version, also used for the remaining triangles of a batch
+
+static void computeScalar
+(const float* coord, const int* coordIndex, const int iT0, const int iT1,
+ float* normal, const bool normalize) {
+  for(int iT=iT0;iT<iT1;iT++) {
+    const float* p  = coord+3*coordIndex[4*iT  ];
+    const float* q1 = coord+3*coordIndex[4*iT+1];
+    const float* q2 = coord+3*coordIndex[4*iT+2];
+    float v1x = q1[0]-p[0], v1y = q1[1]-p[1], v1z = q1[2]-p[2];
+    float v2x = q2[0]-p[0], v2y = q2[1]-p[1], v2z = q2[2]-p[2];
+    float nx = v1y*v2z-v1z*v2y;
+    float ny = v1z*v2x-v1x*v2z;
+    float nz = v1x*v2y-v1y*v2x;
+    if(normalize) {
+      float nn = nx*nx+ny*ny+nz*nz;
+      if(nn>0.0f) {
+        nn = (float)sqrt(nn);
+        nx /= nn; ny /= nn; nz /= nn;
+      }
+    }
+    normal[3*iT  ] = nx;
+    normal[3*iT+1] = ny;
+    normal[3*iT+2] = nz;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+// SIMD versions; each one loads the three vertices of W triangles as
+// nine registers of W coordinates, and stores the normals through a
+// small buffer, to interleave them again
+
+#if defined(TRIANGLE_NORMALS_X86) || defined(TRIANGLE_NORMALS_SSE2_ONLY)
+
+#ifdef TRIANGLE_NORMALS_X86
+__attribute__((target("sse2")))
+#endif
+static void computeSse2
+(const float* coord, const int* coordIndex, const int nT,
+ float* normal, const bool normalize) {
+  const int W = 4;
+  int iT = 0;
+  for(;iT+W<=nT;iT+=W) {
+    const int* ci = coordIndex+4*iT;
+    const float* p0 = coord+3*ci[ 0];
+    const float* p1 = coord+3*ci[ 4];
+    const float* p2 = coord+3*ci[ 8];
+    const float* p3 = coord+3*ci[12];
+    __m128 px = _mm_setr_ps(p0[0],p1[0],p2[0],p3[0]);
+    __m128 py = _mm_setr_ps(p0[1],p1[1],p2[1],p3[1]);
+    __m128 pz = _mm_setr_ps(p0[2],p1[2],p2[2],p3[2]);
+    p0 = coord+3*ci[ 1]; p1 = coord+3*ci[ 5];
+    p2 = coord+3*ci[ 9]; p3 = coord+3*ci[13];
+    __m128 v1x = _mm_sub_ps(_mm_setr_ps(p0[0],p1[0],p2[0],p3[0]),px);
+    __m128 v1y = _mm_sub_ps(_mm_setr_ps(p0[1],p1[1],p2[1],p3[1]),py);
+    __m128 v1z = _mm_sub_ps(_mm_setr_ps(p0[2],p1[2],p2[2],p3[2]),pz);
+    p0 = coord+3*ci[ 2]; p1 = coord+3*ci[ 6];
+    p2 = coord+3*ci[10]; p3 = coord+3*ci[14];
+    __m128 v2x = _mm_sub_ps(_mm_setr_ps(p0[0],p1[0],p2[0],p3[0]),px);
+    __m128 v2y = _mm_sub_ps(_mm_setr_ps(p0[1],p1[1],p2[1],p3[1]),py);
+    __m128 v2z = _mm_sub_ps(_mm_setr_ps(p0[2],p1[2],p2[2],p3[2]),pz);
+    __m128 nx = _mm_sub_ps(_mm_mul_ps(v1y,v2z),_mm_mul_ps(v1z,v2y));
+    __m128 ny = _mm_sub_ps(_mm_mul_ps(v1z,v2x),_mm_mul_ps(v1x,v2z));
+    __m128 nz = _mm_sub_ps(_mm_mul_ps(v1x,v2y),_mm_mul_ps(v1y,v2x));
+    if(normalize) {
+      __m128 nn = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx,nx),_mm_mul_ps(ny,ny)),
+                             _mm_mul_ps(nz,nz));
+      // divide by one where the length is zero
+      __m128 pos = _mm_cmpgt_ps(nn,_mm_setzero_ps());
+      __m128 one = _mm_set1_ps(1.0f);
+      nn = _mm_sqrt_ps(nn);
+      nn = _mm_or_ps(_mm_and_ps(pos,nn),_mm_andnot_ps(pos,one));
+      nx = _mm_div_ps(nx,nn);
+      ny = _mm_div_ps(ny,nn);
+      nz = _mm_div_ps(nz,nn);
+    }
+    float x[W],y[W],z[W];
+    _mm_storeu_ps(x,nx);
+    _mm_storeu_ps(y,ny);
+    _mm_storeu_ps(z,nz);
+    float* n = normal+3*iT;
+    for(int j=0;j<W;j++) {
+      n[3*j  ] = x[j];
+      n[3*j+1] = y[j];
+      n[3*j+2] = z[j];
+    }
+  }
+  computeScalar(coord,coordIndex,iT,nT,normal,normalize);
+}
+
+#endif // TRIANGLE_NORMALS_X86 || TRIANGLE_NORMALS_SSE2_ONLY
+
+#ifdef TRIANGLE_NORMALS_X86
+
+__attribute__((target("avx2")))
+static void computeAvx2
+(const float* coord, const int* coordIndex, const int nT,
+ float* normal, const bool normalize) {
+  const int W = 8;
+  // offsets of the corners of W consecutive triangles in coordIndex
+  const __m256i corner = _mm256_setr_epi32(0,4,8,12,16,20,24,28);
+  const __m256i three  = _mm256_set1_epi32(3);
+  int iT = 0;
+  for(;iT+W<=nT;iT+=W) {
+    const int* ci = coordIndex+4*iT;
+    __m256i i0 = _mm256_mullo_epi32(_mm256_i32gather_epi32(ci  ,corner,4),three);
+    __m256i i1 = _mm256_mullo_epi32(_mm256_i32gather_epi32(ci+1,corner,4),three);
+    __m256i i2 = _mm256_mullo_epi32(_mm256_i32gather_epi32(ci+2,corner,4),three);
+    __m256 px  = _mm256_i32gather_ps(coord  ,i0,4);
+    __m256 py  = _mm256_i32gather_ps(coord+1,i0,4);
+    __m256 pz  = _mm256_i32gather_ps(coord+2,i0,4);
+    __m256 v1x = _mm256_sub_ps(_mm256_i32gather_ps(coord  ,i1,4),px);
+    __m256 v1y = _mm256_sub_ps(_mm256_i32gather_ps(coord+1,i1,4),py);
+    __m256 v1z = _mm256_sub_ps(_mm256_i32gather_ps(coord+2,i1,4),pz);
+    __m256 v2x = _mm256_sub_ps(_mm256_i32gather_ps(coord  ,i2,4),px);
+    __m256 v2y = _mm256_sub_ps(_mm256_i32gather_ps(coord+1,i2,4),py);
+    __m256 v2z = _mm256_sub_ps(_mm256_i32gather_ps(coord+2,i2,4),pz);
+    __m256 nx = _mm256_sub_ps(_mm256_mul_ps(v1y,v2z),_mm256_mul_ps(v1z,v2y));
+    __m256 ny = _mm256_sub_ps(_mm256_mul_ps(v1z,v2x),_mm256_mul_ps(v1x,v2z));
+    __m256 nz = _mm256_sub_ps(_mm256_mul_ps(v1x,v2y),_mm256_mul_ps(v1y,v2x));
+    if(normalize) {
+      __m256 nn = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx,nx),
+                                              _mm256_mul_ps(ny,ny)),
+                                _mm256_mul_ps(nz,nz));
+      // divide by one where the length is zero
+      __m256 pos = _mm256_cmp_ps(nn,_mm256_setzero_ps(),_CMP_GT_OQ);
+      nn = _mm256_blendv_ps(_mm256_set1_ps(1.0f),_mm256_sqrt_ps(nn),pos);
+      nx = _mm256_div_ps(nx,nn);
+      ny = _mm256_div_ps(ny,nn);
+      nz = _mm256_div_ps(nz,nn);
+    }
+    float x[W],y[W],z[W];
+    _mm256_storeu_ps(x,nx);
+    _mm256_storeu_ps(y,ny);
+    _mm256_storeu_ps(z,nz);
+    float* n = normal+3*iT;
+    for(int j=0;j<W;j++) {
+      n[3*j  ] = x[j];
+      n[3*j+1] = y[j];
+      n[3*j+2] = z[j];
+    }
+  }
+  computeScalar(coord,coordIndex,iT,nT,normal,normalize);
+}
+
+// the unmasked gathers leave their source register undefined, which
+// GCC reports as maybe uninitialized; these give it explicitly
+
+__attribute__((target("avx512f")))
+static inline __m512i gatherEpi32(const __m512i index, const int* base) {
+  return _mm512_mask_i32gather_epi32(_mm512_setzero_si512(),0xFFFF,
+                                     index,base,4);
+}
+
+__attribute__((target("avx512f")))
+static inline __m512 gatherPs(const __m512i index, const float* base) {
+  return _mm512_mask_i32gather_ps(_mm512_setzero_ps(),0xFFFF,
+                                  index,base,4);
+}
+
+__attribute__((target("avx512f")))
+static void computeAvx512
+(const float* coord, const int* coordIndex, const int nT,
+ float* normal, const bool normalize) {
+  const int W = 16;
+  // offsets of the corners of W consecutive triangles in coordIndex
+  const __m512i corner = _mm512_setr_epi32( 0, 4, 8,12,16,20,24,28,
+                                           32,36,40,44,48,52,56,60);
+  const __m512i three  = _mm512_set1_epi32(3);
+  int iT = 0;
+  for(;iT+W<=nT;iT+=W) {
+    const int* ci = coordIndex+4*iT;
+    __m512i i0 = _mm512_mullo_epi32(gatherEpi32(corner,ci  ),three);
+    __m512i i1 = _mm512_mullo_epi32(gatherEpi32(corner,ci+1),three);
+    __m512i i2 = _mm512_mullo_epi32(gatherEpi32(corner,ci+2),three);
+    __m512 px  = gatherPs(i0,coord  );
+    __m512 py  = gatherPs(i0,coord+1);
+    __m512 pz  = gatherPs(i0,coord+2);
+    __m512 v1x = _mm512_sub_ps(gatherPs(i1,coord  ),px);
+    __m512 v1y = _mm512_sub_ps(gatherPs(i1,coord+1),py);
+    __m512 v1z = _mm512_sub_ps(gatherPs(i1,coord+2),pz);
+    __m512 v2x = _mm512_sub_ps(gatherPs(i2,coord  ),px);
+    __m512 v2y = _mm512_sub_ps(gatherPs(i2,coord+1),py);
+    __m512 v2z = _mm512_sub_ps(gatherPs(i2,coord+2),pz);
+    __m512 nx = _mm512_sub_ps(_mm512_mul_ps(v1y,v2z),_mm512_mul_ps(v1z,v2y));
+    __m512 ny = _mm512_sub_ps(_mm512_mul_ps(v1z,v2x),_mm512_mul_ps(v1x,v2z));
+    __m512 nz = _mm512_sub_ps(_mm512_mul_ps(v1x,v2y),_mm512_mul_ps(v1y,v2x));
+    if(normalize) {
+      __m512 nn = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(nx,nx),
+                                              _mm512_mul_ps(ny,ny)),
+                                _mm512_mul_ps(nz,nz));
+      // divide by one where the length is zero
+      __mmask16 pos = _mm512_cmp_ps_mask(nn,_mm512_setzero_ps(),_CMP_GT_OQ);
+      nn = _mm512_mask_sqrt_ps(_mm512_set1_ps(1.0f),pos,nn);
+      nx = _mm512_div_ps(nx,nn);
+      ny = _mm512_div_ps(ny,nn);
+      nz = _mm512_div_ps(nz,nn);
+    }
+    float x[W],y[W],z[W];
+    _mm512_storeu_ps(x,nx);
+    _mm512_storeu_ps(y,ny);
+    _mm512_storeu_ps(z,nz);
+    float* n = normal+3*iT;
+    for(int j=0;j<W;j++) {
+      n[3*j  ] = x[j];
+      n[3*j+1] = y[j];
+      n[3*j+2] = z[j];
+    }
+  }
+  computeScalar(coord,coordIndex,iT,nT,normal,normalize);
+}
+
+#endif // TRIANGLE_NORMALS_X86
+
+//////////////////////////////////////////////////////////////////////
+static TriangleNormals::Isa detectIsa() {
+#if defined(TRIANGLE_NORMALS_X86)
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx512f")) return TriangleNormals::ISA_AVX512;
+  if(__builtin_cpu_supports("avx2"))    return TriangleNormals::ISA_AVX2;
+  if(__builtin_cpu_supports("sse2"))    return TriangleNormals::ISA_SSE2;
+#elif defined(TRIANGLE_NORMALS_SSE2_ONLY)
+  return TriangleNormals::ISA_SSE2;
+#endif
+  return TriangleNormals::ISA_SCALAR;
+}
+
+static TriangleNormals::Isa s_supportedIsa = detectIsa();
+static TriangleNormals::Isa s_isa          = s_supportedIsa;
+
+TriangleNormals::Isa TriangleNormals::getSupportedIsa() {
+  return s_supportedIsa;
+}
+
+TriangleNormals::Isa TriangleNormals::getIsa() {
+  return s_isa;
+}
+
+void TriangleNormals::setIsa(const Isa isa) {
+  s_isa = (isa<s_supportedIsa)?isa:s_supportedIsa;
+}
+
+const char* TriangleNormals::getIsaName(const Isa isa) {
+  switch(isa) {
+  case ISA_SSE2:   return "sse2";
+  case ISA_AVX2:   return "avx2";
+  case ISA_AVX512: return "avx512";
+  default:         return "scalar";
+  }
+}
+
+void TriangleNormals::compute
+(const float* coord, const int* coordIndex, const int nT,
+ float* normal, const bool normalize) {
+  if(nT<=0) return;
+  switch(s_isa) {
+#if defined(TRIANGLE_NORMALS_X86)
+  case ISA_AVX512:
+    computeAvx512(coord,coordIndex,nT,normal,normalize);
+    break;
+  case ISA_AVX2:
+    computeAvx2(coord,coordIndex,nT,normal,normalize);
+    break;
+#endif
+#if defined(TRIANGLE_NORMALS_X86) || defined(TRIANGLE_NORMALS_SSE2_ONLY)
+  case ISA_SSE2:
+    computeSse2(coord,coordIndex,nT,normal,normalize);
+    break;
+#endif
+  default:
+    computeScalar(coord,coordIndex,0,nT,normal,normalize);
+    break;
+  }
+}
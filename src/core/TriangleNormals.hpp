@@ -0,0 +1,75 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// TriangleNormals.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _TRIANGLE_NORMALS_HPP_
+#define _TRIANGLE_NORMALS_HPP_
+
+// Batched face normals of a triangle mesh, where every face occupies
+// four coordIndex entries, the last of which is the -1 separator.
+//
+// The triangles are processed in groups of 16 (AVX-512), 8 (AVX2) or
+// 4 (SSE2), with the vertex coordinates gathered into one register per
+// coordinate, or one at a time by the scalar code. The instruction set
+// is chosen at run time, from what the processor supports. All the
+// versions evaluate the same expressions, in the same order, as
+// SceneGraphProcessor::_computeFaceNormal, without fused multiply-add
+// instructions, so the results are bit-identical on every machine.
+
+class TriangleNormals {
+
+public:
+
+  enum Isa { ISA_SCALAR = 0, ISA_SSE2, ISA_AVX2, ISA_AVX512 };
+
+  // best instruction set supported by the processor
+  static Isa         getSupportedIsa();
+
+  // instruction set used by compute(); initially the supported one
+  static Isa         getIsa();
+  static const char* getIsaName(const Isa isa);
+
+  // values above the supported instruction set are clamped, so that
+  // the other versions can be tested and timed
+  static void        setIsa(const Isa isa);
+
+  // computes the normals of the nT triangles in coordIndex, and stores
+  // them in normal[3*iT..3*iT+2]; if normalize is true the normals
+  // with non-zero length are normalized
+  static void        compute(const float* coord, const int* coordIndex,
+                             const int nT, float* normal,
+                             const bool normalize);
+
+};
+
+#endif /* _TRIANGLE_NORMALS_HPP_ */
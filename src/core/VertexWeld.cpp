@@ -0,0 +1,195 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// VertexWeld.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include "VertexWeld.hpp"
+
+// open addressing hash table of grid cells; a cell is empty if its
+// head is -1, and otherwise it points to the first welded vertex of a
+// list linked through the next array
+
+static inline size_t cellHash(const int64_t* k, const size_t mask) {
+  uint64_t h =
+    ((uint64_t)k[0]*0x9E3779B97F4A7C15ULL)^
+    ((uint64_t)k[1]*0xC2B2AE3D27D4EB4FULL)^
+    ((uint64_t)k[2]*0x165667B19E3779F9ULL);
+  h ^= h>>29;
+  return (size_t)h&mask;
+}
+
+static inline size_t cellFind
+(const vector<int64_t>& key, const vector<int>& head,
+ const int64_t* k, const size_t mask) {
+  size_t i = cellHash(k,mask);
+  while(head[i]>=0) {
+    if(key[3*i]==k[0] && key[3*i+1]==k[1] && key[3*i+2]==k[2]) break;
+    i = (i+1)&mask;
+  }
+  return i;
+}
+
+VertexWeld::VertexWeld(const float epsilon):
+  _epsilon((epsilon>0.0f)?epsilon:0.0f),
+  _nWelded(0) {
+}
+
+float VertexWeld::getEpsilon() const {
+  return _epsilon;
+}
+
+int VertexWeld::weld(const vector<float>& coord) {
+
+  int nV = (int)(coord.size()/3);
+  _map.assign(nV,-1);
+  _first.clear();
+  _nWelded = 0;
+  if(nV==0) return 0;
+
+  // the number of cells is at most nV, so the load factor of the
+  // table is at most 1/2
+  size_t size = 1;
+  while(size<2*(size_t)nV) size <<= 1;
+  size_t mask = size-1;
+  vector<int64_t> key(3*size);
+  vector<int>     head(size,-1);
+  vector<int>     next;
+  next.reserve(nV);
+
+  bool   exact = (_epsilon==0.0f);
+  double scale = (exact)?0.0:1.0/(double)_epsilon;
+  double eps2  = (double)_epsilon*(double)_epsilon;
+
+  int64_t k[3],kk[3];
+  size_t  i;
+  int     iV,iW,j;
+  for(iV=0;iV<nV;iV++) {
+    const float* p = &coord[3*iV];
+
+    if(exact) {
+      // the cell is the bit pattern of the coordinates, with -0
+      // mapped to +0; all the vertices in a cell are equal
+      for(j=0;j<3;j++) {
+        float    x = (p[j]==0.0f)?0.0f:p[j];
+        uint32_t b;
+        memcpy(&b,&x,4);
+        k[j] = (int64_t)b;
+      }
+      i  = cellFind(key,head,k,mask);
+      iW = head[i];
+    } else {
+      for(j=0;j<3;j++) {
+        double x = floor((double)p[j]*scale);
+        if(!(x>-4.0e18)) x = -4.0e18; // also catches NaN
+        if(!(x< 4.0e18)) x =  4.0e18;
+        k[j] = (int64_t)x;
+      }
+      // search the cell of the vertex first, where most matches are
+      iW = -1;
+      for(int e=0;e<27 && iW<0;e++) {
+        int d = (e+13)%27;
+        kk[0] = k[0]+d%3-1;
+        kk[1] = k[1]+(d/3)%3-1;
+        kk[2] = k[2]+d/9-1;
+        size_t c = cellFind(key,head,kk,mask);
+        for(int w=head[c];w>=0;w=next[w]) {
+          const float* q = &coord[3*_first[w]];
+          double dx = (double)p[0]-(double)q[0];
+          double dy = (double)p[1]-(double)q[1];
+          double dz = (double)p[2]-(double)q[2];
+          if(dx*dx+dy*dy+dz*dz<=eps2) { iW = w; break; }
+        }
+      }
+      if(iW<0) i = cellFind(key,head,k,mask);
+    }
+
+    if(iW<0) {
+      // new welded vertex, pushed at the front of its cell list
+      iW = _nWelded++;
+      _first.push_back(iV);
+      next.push_back(head[i]);
+      key[3*i  ] = k[0];
+      key[3*i+1] = k[1];
+      key[3*i+2] = k[2];
+      head[i]    = iW;
+    }
+    _map[iV] = iW;
+  }
+
+  return _nWelded;
+}
+
+int VertexWeld::getNumberOfVertices() const {
+  return (int)_map.size();
+}
+
+int VertexWeld::getNumberOfWeldedVertices() const {
+  return _nWelded;
+}
+
+int VertexWeld::getVertexMap(const int iV) const {
+  return (0<=iV && iV<(int)_map.size())?_map[iV]:-1;
+}
+
+const vector<int>& VertexWeld::getVertexMap() const {
+  return _map;
+}
+
+void VertexWeld::remapIndex(vector<int>& coordIndex) const {
+  int nV = (int)_map.size();
+  for(size_t i=0;i<coordIndex.size();i++) {
+    int iV = coordIndex[i];
+    if(0<=iV && iV<nV) coordIndex[i] = _map[iV];
+  }
+}
+
+void VertexWeld::compact(vector<float>& value, const int dim) const {
+  if(dim<=0 || value.size()!=(size_t)dim*_map.size()) return;
+  // _first is increasing, so the values can be moved in place
+  for(int iW=0;iW<_nWelded;iW++) {
+    size_t src = (size_t)dim*_first[iW];
+    size_t dst = (size_t)dim*iW;
+    for(int j=0;j<dim;j++)
+      value[dst+j] = value[src+j];
+  }
+  value.resize((size_t)dim*_nWelded);
+}
+
+int VertexWeld::apply(vector<float>& coord, vector<int>& coordIndex) {
+  weld(coord);
+  compact(coord,3);
+  remapIndex(coordIndex);
+  return _nWelded;
+}
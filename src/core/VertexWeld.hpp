@@ -0,0 +1,98 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// VertexWeld.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _VERTEX_WELD_HPP_
+#define _VERTEX_WELD_HPP_
+
+#include <vector>
+
+using namespace std;
+
+// Merges coincident vertices of a polygon mesh, such as the three
+// separate vertices which the STL format stores for every facet.
+//
+// In exact mode (epsilon==0) two vertices are merged if their
+// coordinates are equal. Otherwise a vertex is merged with the first
+// previously kept vertex which lies within distance epsilon; the
+// vertices are bucketed in a uniform grid of cell size epsilon, so
+// that only the 27 neighboring cells have to be searched. In both
+// modes the grid cells are stored in an open addressing hash table,
+// and the running time is linear in the number of vertices.
+//
+// The kept vertices preserve their relative order, so the result is
+// deterministic. Welding may collapse small faces into degenerate
+// faces with repeated vertices; those faces are not removed, so that
+// arrays bound per face remain valid.
+
+class VertexWeld {
+
+public:
+
+          VertexWeld(const float epsilon=0.0f);
+
+  float   getEpsilon() const;
+
+  // Computes the map from the nV=coord.size()/3 input vertices to
+  // the welded vertices, and returns the number of welded vertices.
+  int     weld(const vector<float>& coord);
+
+  int     getNumberOfVertices()        const; // before welding
+  int     getNumberOfWeldedVertices()  const;
+
+  // Index of the welded vertex for input vertex iV, or -1.
+  int     getVertexMap(const int iV)   const;
+  const vector<int>& getVertexMap()    const;
+
+  // Replaces the vertex indices of a coordIndex array; -1 separators
+  // and out of range indices are left unchanged.
+  void    remapIndex(vector<int>& coordIndex) const;
+
+  // Compacts an array of values bound per vertex, with dim values per
+  // vertex, keeping the values of the first vertex of each welded
+  // group. The array must have dim*getNumberOfVertices() values.
+  void    compact(vector<float>& value, const int dim) const;
+
+  // Convenience method: weld, compact coord, and remap coordIndex.
+  int     apply(vector<float>& coord, vector<int>& coordIndex);
+
+private:
+
+  float       _epsilon;
+  int         _nWelded;
+  vector<int> _map;
+  vector<int> _first; // first input vertex of each welded vertex
+
+};
+
+#endif /* _VERTEX_WELD_HPP_ */
@@ -35,236 +35,420 @@
 #include <iostream>
 #include <math.h>
 #include "GuiGLBuffer.hpp"
+#include "util/ThreadPool.hpp"
 
 //////////////////////////////////////////////////////////////////////
 GuiGLBuffer::GuiGLBuffer():
   QOpenGLBuffer(),
+  _indexBuffer(QOpenGLBuffer::IndexBuffer),
   _type(MATERIAL),
   _nVertices(0),
   _nNormals(0),
   _nColors(0),
+  _nIndices(0),
   _hasFaces(false),
   _hasPolylines(false),
   _hasColor(false),
-  _hasNormal(false) {
+  _hasNormal(false),
+  _isIndexed(false),
+  _pIfs((IndexedFaceSet*)0),
+  _normalBinding(IndexedFaceSet::PB_NONE),
+  _colorBinding(IndexedFaceSet::PB_NONE),
+  _nCoordIndex(0),
+  _vertexUploaded(0),
+  _indexUploaded(0),
+  _uploaded(false) {
 }
 
 //////////////////////////////////////////////////////////////////////
-GuiGLBuffer::GuiGLBuffer(IndexedFaceSet* pIfs, QColor& materialColor):
+// Interleaved coordinates, normal and color of the buffer vertices of
+// an IndexedFaceSet. When the faces are drawn as a triangle soup, the
+// buffer vertices are the corners of the triangles of each face,
+// fanned from its first corner, with their corners in reverse order;
+// otherwise they are the coordinates, shared by the faces.
+class FaceSetVertices {
+
+public:
+
+  FaceSetVertices(IndexedFaceSet& ifs):
+    _coord(ifs.getCoord()),
+    _coordIndex(ifs.getCoordIndex()),
+    _normal(ifs.getNormal()),
+    _normalIndex(ifs.getNormalIndex()),
+    _color(ifs.getColor()),
+    _colorIndex(ifs.getColorIndex()),
+    _hasNormal(ifs.getNormal().size()>0),
+    _hasColor(ifs.getColor().size()>0),
+    _normalPerVertex(ifs.getNormalPerVertex()),
+    _colorPerVertex(ifs.getColorPerVertex()) {
+  }
+
+  // calls f(iV,iN,iC) for the buffer vertices of the triangles of face
+  // iF, which occupies corners [i0,i1); iN and iC are the normal and
+  // color indices, or -1 without normals or colors
+  template<class F>
+  void face(int iF, int i0, int i1, F& f) const {
+    int iV,iN=-1,iC=-1,k,j[3];
+    if(_hasNormal && _normalPerVertex==false)
+      // NORMAL_PER_FACE_INDEXED or NORMAL_PER_FACE
+      iN = (_normalIndex.size()>0)?_normalIndex[iF]:iF;
+    if(_hasColor && _colorPerVertex==false)
+      // COLOR_PER_FACE_INDEXED or COLOR_PER_FACE
+      iC = (_colorIndex.size()>0)?_colorIndex[iF]:iF;
+    for(j[0]=i0,j[1]=i0+1,j[2]=i0+2;j[2]<i1;j[1]=j[2]++) {
+      for(k=2;k>=0;k--) {
+        iV = _coordIndex[j[k]];
+        if(_hasNormal && _normalPerVertex==true)
+          // NORMAL_PER_CORNER or NORNAL_PER_VERTEX
+          iN = (_normalIndex.size()>0)?_normalIndex[j[k]]:iV;
+        if(_hasColor && _colorPerVertex==true)
+          // COLOR_PER_CORNER or COLOR_PER_VERTEX
+          iC = (_colorIndex.size()>0)?_colorIndex[j[k]]:iV;
+        f(iV,iN,iC);
+      }
+    }
+  }
+
+  // calls f(iV,iN,iC) for the shared vertices [iV0,iV1)
+  template<class F>
+  void vertices(int iV0, int iV1, F& f) const {
+    for(int iV=iV0;iV<iV1;iV++)
+      f(iV,(_hasNormal)?iV:-1,(_hasColor)?iV:-1);
+  }
+
+  // writes the attributes of a buffer vertex, and returns the position
+  // of the next one
+  GLfloat* write(GLfloat* p, int iV, int iN, int iC) const {
+    p[0] = _coord[3*iV  ];
+    p[1] = _coord[3*iV+1];
+    p[2] = _coord[3*iV+2];
+    p += 3;
+    if(_hasNormal) {
+      p[0] = _normal[3*iN  ];
+      p[1] = _normal[3*iN+1];
+      p[2] = _normal[3*iN+2];
+      p += 3;
+    }
+    if(_hasColor) {
+      p[0] = _color[3*iC  ];
+      p[1] = _color[3*iC+1];
+      p[2] = _color[3*iC+2];
+      p += 3;
+    }
+    return p;
+  }
+
+private:
+
+  const vector<float>& _coord;
+  const vector<int>&   _coordIndex;
+  const vector<float>& _normal;
+  const vector<int>&   _normalIndex;
+  const vector<float>& _color;
+  const vector<int>&   _colorIndex;
+  bool                 _hasNormal;
+  bool                 _hasColor;
+  bool                 _normalPerVertex;
+  bool                 _colorPerVertex;
+};
+
+//////////////////////////////////////////////////////////////////////
+GuiGLBuffer::GuiGLBuffer
+(IndexedFaceSet* pIfs, QColor& materialColor, const bool deferUpload):
   QOpenGLBuffer(),
+  _indexBuffer(QOpenGLBuffer::IndexBuffer),
   _nVertices(0),
   _nNormals(0),
   _nColors(0),
+  _nIndices(0),
   _hasFaces(false),
   _hasPolylines(false),
   _hasColor(false),
-  _hasNormal(false) {
-
-  // std::cout << "GuiGLBuffer::GuiGLBuffer(IndexedFaceSet) {\n";
-
-  QVector<QVector3D> m_vertices;
-  QVector<QVector3D> m_normals;
-  QVector<QVector3D> m_colors;
+  _hasNormal(false),
+  _isIndexed(false),
+  _pIfs((IndexedFaceSet*)0),
+  _normalBinding(IndexedFaceSet::PB_NONE),
+  _colorBinding(IndexedFaceSet::PB_NONE),
+  _nCoordIndex(0),
+  _vertexUploaded(0),
+  _indexUploaded(0),
+  _uploaded(false) {
+
+  (void)materialColor;
 
   if(pIfs==(IndexedFaceSet*)0) return;
 
-  vector<float>& coord       = pIfs->getCoord();
   vector<int>&   coordIndex  = pIfs->getCoordIndex();
-
-  bool           colorPerVertex = pIfs->getColorPerVertex();
-  vector<float>& color       = pIfs->getColor();
-  vector<int>&   colorIndex  = pIfs->getColorIndex();
-  // IndexedFaceSet::Binding   cBinding    = pIfs->getColorBinding();
-
-  bool           normalPerVertex = pIfs->getNormalPerVertex();
   vector<float>& normal      = pIfs->getNormal();
-  vector<int>&   normalIndex = pIfs->getNormalIndex();
-  // IndexedFaceSet::Binding   nBinding    = pIfs->getNormalBinding();
-
-  // int         nV          = pIfs->getNumberOfCoord();
-  int            nF          = pIfs->getNumberOfFaces();
-
-  // material color values in [0.0:1.0] range
-  float /*qreal*/ matR,matG,matB,matA;
-  materialColor.getRgbF(&matR,&matG,&matB,&matA);
-  QVector3D matColor(matR,matG,matB);
+  vector<float>& color       = pIfs->getColor();
+  int            nV          = pIfs->getNumberOfCoord();
+
+  // faces; face iF occupies corners [faceFirst[iF],faceFirst[iF+1]-1),
+  // and is split into triangles [triangleFirst[iF],triangleFirst[iF+1])
+  vector<int> faceFirst;
+  vector<int> triangleFirst;
+  faceFirst.push_back(0);
+  triangleFirst.push_back(0);
+  for(int i1=0;i1<(int)coordIndex.size();i1++) {
+    if(coordIndex[i1]<0) {
+      int nTi = i1-faceFirst.back()-2;
+      triangleFirst.push_back(triangleFirst.back()+((nTi>0)?nTi:0));
+      faceFirst.push_back(i1+1);
+    }
+  }
+  int nF = (int)faceFirst.size()-1;
+  int nT = triangleFirst[nF];
 
   _hasFaces  = (nF>0);
-  _hasNormal = (normal.size()>0); // (nBinding!=IndexedFaceSet::Binding::PB_NONE);
-  _hasColor  = (color.size()>0);  // cBinding!=IndexedFaceSet::Binding::PB_NONE);
+  _hasNormal = (normal.size()>0);
+  _hasColor  = (color.size()>0);
 
   _type =
     (_hasColor)?
     ((_hasNormal)?COLOR_NORMAL:COLOR):((_hasNormal)?MATERIAL_NORMAL:MATERIAL);
 
-  m_vertices.clear();
-  m_normals.clear();
-  m_colors.clear();
-
-  if(_hasFaces) {
-    // polygon mesh
-
-    float x[3][3];
-    float n[3][3];
-    float c[3][3];
-    int   j[3];
-
-    int iN,iC,iV,k,h,i0,i1,iF;
-    for(iF=i0=i1=0;i1<(int)coordIndex.size();i1++) {
-      if(coordIndex[i1]<0) {
-        // number of triangles in this face
-        // nTrianglesFace = i1-i0-2;
-
-        if(_hasNormal && normalPerVertex==false) {
-          // NORMAL_PER_FACE_INDEXED or NORMAL_PER_FACE
-          iN = (normalIndex.size()>0)?normalIndex[iF]:iF;
-          for(h=0;h<3;h++)
-            n[0][h] = n[1][h] = n[2][h] = normal[3*iN+h];
-        }
+  _pIfs          = pIfs;
+  _normalBinding = pIfs->getNormalBinding();
+  _colorBinding  = pIfs->getColorBinding();
+  _nCoordIndex   = (unsigned)coordIndex.size();
+  pIfs->clearChanged(IndexedFaceSet::CHANGED_COORD);
+  pIfs->clearChanged(IndexedFaceSet::CHANGED_NORMAL);
+  pIfs->clearChanged(IndexedFaceSet::CHANGED_COLOR);
+  pIfs->clearChanged(IndexedFaceSet::CHANGED_COORD_INDEX);
+
+  // when the normals and colors, if any, are bound per vertex, the
+  // vertices are stored once, and the triangles as an element buffer of
+  // vertex indices; otherwise each triangle corner gets its own copy of
+  // the vertex attributes
+  _isIndexed = _hasFaces &&
+    (_normalBinding==IndexedFaceSet::PB_NONE ||
+     _normalBinding==IndexedFaceSet::PB_PER_VERTEX) &&
+    (_colorBinding==IndexedFaceSet::PB_NONE ||
+     _colorBinding==IndexedFaceSet::PB_PER_VERTEX);
+
+  // IndexedFaceSets without faces are drawn as point clouds
+  _nVertices = (_hasFaces && _isIndexed==false)?3*nT:nV;
+  _nNormals  = (_hasNormal)?_nVertices:0;
+  _nColors   = (_hasColor )?_nVertices:0;
+
+  // the exact sizes are known, so the interleaved data is written in
+  // place into a single staging array, in parallel over ranges of faces
+  // or vertices, and uploaded with one call
+  ThreadPool&     pool   = ThreadPool::getInstance();
+  FaceSetVertices source(*pIfs);
+  int             stride = 3+((_hasNormal)?3:0)+((_hasColor)?3:0);
+  vector<GLfloat>& buf   = _vertexData;
+  buf.resize((size_t)stride*_nVertices);
+  if(_hasFaces && _isIndexed==false) {
+    pool.runRange(nF,4096,[&](int iF0, int iF1) {
+        GLfloat* p = buf.data()+(size_t)stride*3*triangleFirst[iF0];
+        auto write = [&](int iV, int iN, int iC) {
+          p = source.write(p,iV,iN,iC);
+        };
+        for(int iF=iF0;iF<iF1;iF++)
+          source.face(iF,faceFirst[iF],faceFirst[iF+1]-1,write);
+      });
+  } else {
+    pool.runRange(nV,65536,[&](int iV0, int iV1) {
+        GLfloat* p = buf.data()+(size_t)stride*iV0;
+        auto write = [&](int iV, int iN, int iC) {
+          p = source.write(p,iV,iN,iC);
+        };
+        source.vertices(iV0,iV1,write);
+      });
+  }
 
-        if(_hasColor && colorPerVertex==false) {
-          // COLOR_PER_FACE_INDEXED or COLOR_PER_FACE
-          iC = (colorIndex.size()>0)?colorIndex[iF]:iF;
-          for(h=0;h<3;h++)
-            c[0][h] = c[1][h] = c[2][h] = color[3*iC+h];
+  if(_isIndexed) {
+    // the triangles of the soup above, as vertex indices
+    vector<GLuint>& index = _indexData;
+    index.resize(3*(size_t)nT);
+    pool.runRange(nF,4096,[&](int iF0, int iF1) {
+        GLuint* q = index.data()+3*(size_t)triangleFirst[iF0];
+        for(int iF=iF0;iF<iF1;iF++) {
+          int i0 = faceFirst[iF];
+          int i1 = faceFirst[iF+1]-1;
+          for(int j1=i0+1,j2=i0+2;j2<i1;j1=j2++) {
+            *q++ = (GLuint)coordIndex[j2];
+            *q++ = (GLuint)coordIndex[j1];
+            *q++ = (GLuint)coordIndex[i0];
+          }
         }
+      });
+    _nIndices = (unsigned)index.size();
+  }
 
-        // triangulate face [i0:i1) on the fly and add triangles to current mesh
-        for(j[0]=i0,j[1]=i0+1,j[2]=i0+2;j[2]<i1;j[1]=j[2]++) {
-          // triangle [j0,j1,j2]
-          for(k=0;k<3;k++) {
-            // get vertex coordinates
-            iV = coordIndex[j[k]];
-            for(h=0;h<3;h++)
-              x[k][h] = coord[3*iV+h];
-
-            if(_hasNormal && normalPerVertex==true) {
-              // NORMAL_PER_CORNER or NORNAL_PER_VERTEX
-              iN = (normalIndex.size()>0)?normalIndex[j[k]]:iV;
-              for(h=0;h<3;h++)
-                n[k][h] = normal[3*iN+h];
-            }
+  if(deferUpload==false) upload();
+}
 
-            if(_hasColor && colorPerVertex==true) {
-              // COLOR_PER_CORNER or COLOR_PER_VERTEX
-              iC = (colorIndex.size()>0)?colorIndex[j[k]]:iV;
-              for(h=0;h<3;h++)
-                c[k][h] = color[3*iC+h];
-            }
+//////////////////////////////////////////////////////////////////////
+bool GuiGLBuffer::upload(const size_t maxBytes) {
+  if(_uploaded) return true;
+
+  size_t vertexSize = _vertexData.size()*sizeof(GLfloat);
+  size_t indexSize  = _indexData.size()*sizeof(GLuint);
+  size_t budget     = (maxBytes>0)?maxBytes:vertexSize+indexSize;
+
+  // the storage of each buffer is allocated by the first call, and
+  // filled from the staged data if it fits in the budget; otherwise it
+  // is filled in slices by this and the following calls
+  auto fill = [&](QOpenGLBuffer& buffer, const void* data,
+                  const size_t size, size_t& uploaded) {
+    const char* bytes = (const char*)data;
+    buffer.bind();
+    if(uploaded==0 && budget>=size) {
+      buffer.allocate(bytes,(int)size);
+      uploaded = size;
+      budget  -= size;
+    } else {
+      if(uploaded==0) buffer.allocate((int)size);
+      size_t n = (size-uploaded<budget)?size-uploaded:budget;
+      if(n>0) buffer.write((int)uploaded,bytes+uploaded,(int)n);
+      uploaded += n;
+      budget   -= n;
+    }
+    buffer.release();
+  };
+
+  if(this->isCreated()==false) this->create();
+  if(_vertexUploaded<vertexSize || vertexSize==0)
+    fill(*this,_vertexData.data(),vertexSize,_vertexUploaded);
+  if(_isIndexed) {
+    if(_indexBuffer.isCreated()==false) _indexBuffer.create();
+    if(_indexUploaded<indexSize || indexSize==0)
+      fill(_indexBuffer,_indexData.data(),indexSize,_indexUploaded);
+  }
 
-          }
+  if(_vertexUploaded==vertexSize &&
+     (_isIndexed==false || _indexUploaded==indexSize)) {
+    vector<GLfloat>().swap(_vertexData);
+    vector<GLuint>().swap(_indexData);
+    _uploaded = true;
+  }
+  return _uploaded;
+}
 
-          // push values into buffers
-          for(k=2;k>=0;k--) {
-            m_vertices.append(QVector3D(x[k][0],x[k][1],x[k][2]));
-            if(_hasNormal)
-              m_normals.append(QVector3D(n[k][0],n[k][1],n[k][2]));
-            if(_hasColor)
-              m_colors.append(QVector3D(c[k][0],c[k][1],c[k][2]));
-          }
-        }
+// Marks the elements of the ranges recorded as changed in an
+// IndexedFaceSet, and clears them; n is the number of elements.
+static void getChanged
+(IndexedFaceSet& ifs, IndexedFaceSet::Change c, int n, vector<char>& mark) {
+  mark.assign(n,0);
+  vector<int>& range = ifs.getChanged(c);
+  for(int j=0;j+1<(int)range.size();j+=2)
+    for(int i=range[j];i<range[j+1] && i<n;i++)
+      mark[i] = 1;
+  ifs.clearChanged(c);
+}
 
-        // advance to next face
-        i0 = i1+1; iF++;
+//////////////////////////////////////////////////////////////////////
+bool GuiGLBuffer::update() {
+  if(_pIfs==(IndexedFaceSet*)0 || _uploaded==false) return true;
+  IndexedFaceSet& ifs = *_pIfs;
+  if(ifs.hasChanged(IndexedFaceSet::CHANGED_COORD)==false &&
+     ifs.hasChanged(IndexedFaceSet::CHANGED_NORMAL)==false &&
+     ifs.hasChanged(IndexedFaceSet::CHANGED_COLOR)==false &&
+     ifs.hasChanged(IndexedFaceSet::CHANGED_COORD_INDEX)==false)
+    return true;
+
+  vector<float>& coord  = ifs.getCoord();
+  vector<float>& normal = ifs.getNormal();
+  vector<float>& color  = ifs.getColor();
+
+  // the faces and the bindings must be the same as when the buffer was
+  // built; any recorded edit of coordIndex changes the layout
+  if(ifs.hasChanged(IndexedFaceSet::CHANGED_COORD_INDEX) ||
+     ifs.getCoordIndex().size()!=_nCoordIndex ||
+     (normal.size()>0)!=_hasNormal ||
+     (color.size()>0)!=_hasColor ||
+     ifs.getNormalBinding()!=_normalBinding ||
+     ifs.getColorBinding()!=_colorBinding ||
+     ((_hasFaces==false || _isIndexed) &&
+      (unsigned)ifs.getNumberOfCoord()!=_nVertices))
+    return false;
+
+  int nV = (int)(coord.size()/3);
+  int nN = (int)(normal.size()/3);
+  int nC = (int)(color.size()/3);
+  vector<char> coordMark,normalMark,colorMark;
+  getChanged(ifs,IndexedFaceSet::CHANGED_COORD ,nV,coordMark);
+  getChanged(ifs,IndexedFaceSet::CHANGED_NORMAL,nN,normalMark);
+  getChanged(ifs,IndexedFaceSet::CHANGED_COLOR ,nC,colorMark);
+
+  // interleaved vertex, normal and color, as in the constructor; runs
+  // separated by a few unchanged vertices are written together
+  const int maxGap = 32;
+  int stride = (3+((_hasNormal)?3:0)+((_hasColor)?3:0))*sizeof(GLfloat);
+  vector<GLfloat> run;
+  int iRun = 0; // buffer vertex where the current run starts
+  int nGap = 0; // unchanged vertices at the end of the current run
+  int iB   = 0; // current buffer vertex
+
+  FaceSetVertices source(ifs);
+  auto visit = [&](int iV, int iN, int iC) {
+    bool changed =
+      (iV>=0 && iV<nV && coordMark[iV]) ||
+      (iN>=0 && iN<nN && normalMark[iN]) ||
+      (iC>=0 && iC<nC && colorMark[iC]);
+    if(changed || run.size()>0) {
+      if(run.size()==0) iRun = iB;
+      nGap = (changed)?0:nGap+1;
+      size_t k = run.size();
+      run.resize(k+stride/sizeof(GLfloat));
+      source.write(&run[k],iV,iN,iC);
+      if(nGap>maxGap) {
+        int size = (int)(run.size()*sizeof(GLfloat))-nGap*stride;
+        this->write(iRun*stride,run.data(),size);
+        run.clear();
+        nGap = 0;
       }
     }
+    iB++;
+  };
 
-  } else /*if(!_hasFaces)*/ {
-    
-    // treat as point cloud
-
-    // assert(normalPerVertex==true);
-    // assert(normalIndex.size()==0);
-    // assert(normal.size()==0 || normal.size()==coord.size());
-
-    // assert(colorPerVertex==true);
-    // assert(colorIndex.size()==0);
-    // assert(color.size()==0 || color.size()==coord.size());
-
-    unsigned iV,nVertices;
-    nVertices = pIfs->getNumberOfCoord();
-    float x[3],n[3],c[3];
-    for(iV=0;iV<nVertices;iV++) {
-      x[0] = coord[3*iV  ];
-      x[1] = coord[3*iV+1];
-      x[2] = coord[3*iV+2];
-      m_vertices.append(QVector3D(x[0],x[1],x[2]));
-      if(_hasNormal) {
-        n[0] = normal[3*iV  ];
-        n[1] = normal[3*iV+1];
-        n[2] = normal[3*iV+2];
-        m_normals.append(QVector3D(n[0],n[1],n[2]));
-      }
-      if(_hasColor) {
-        c[0] = color[3*iV  ];
-        c[1] = color[3*iV+1];
-        c[2] = color[3*iV+2];
-        m_colors.append(QVector3D(c[0],c[1],c[2]));
+  this->bind();
+  if(_hasFaces && _isIndexed==false) {
+    vector<int>& coordIndex = ifs.getCoordIndex();
+    int iF,i0,i1;
+    for(iF=i0=i1=0;i1<(int)coordIndex.size();i1++) {
+      if(coordIndex[i1]<0) {
+        source.face(iF,i0,i1,visit);
+        i0 = i1+1; iF++;
       }
     }
+  } else {
+    source.vertices(0,nV,visit);
   }
-
-  _nVertices = m_vertices.count();
-  _nNormals  = m_normals.count();
-  _nColors   = m_colors.count();
-
-  // Use a vertex buffer object.
-
-  this->create();
-  this->bind();
-  QVector<GLfloat> buf;
-  buf.resize(3*_nVertices+3*_nNormals+3*_nColors);
-
-  GLfloat *p = buf.data();
-  for (unsigned i = 0; i < _nVertices; ++i) {
-    // vertex coordinates
-    *p++ = m_vertices[i].x();
-    *p++ = m_vertices[i].y();
-    *p++ = m_vertices[i].z();
-    // vertex normals
-    if(_nNormals>0) {
-      *p++ = m_normals[i].x();
-      *p++ = m_normals[i].y();
-      *p++ = m_normals[i].z();
-    }
-    // vertex colors
-    if(_nColors>0) {
-      *p++ = m_colors[i].x();
-      *p++ = m_colors[i].y();
-      *p++ = m_colors[i].z();
-    }
+  if(run.size()>0) {
+    int size = (int)(run.size()*sizeof(GLfloat))-nGap*stride;
+    this->write(iRun*stride,run.data(),size);
   }
-  this->allocate(buf.constData(), buf.count() * sizeof(GLfloat));
   this->release();
-
-  // std::cout << "  _nVertices    = " << _nVertices << "\n";
-  // std::cout << "  _nNormals     = " << _nNormals << "\n";
-  // std::cout << "  _nColors      = " << _nColors << "\n";
-  // std::cout << "  _hasFaces     = " << _hasFaces << "\n";
-  // std::cout << "  _hasPolylines = " << _hasPolylines << "\n";
-  // std::cout << "  _hasColor     = " << _hasColor << "\n";
-  // std::cout << "  _hasNormal    = " << _hasNormal << "\n";
-
-  // std::cout << "}\n";
+  return true;
 }
-
+
 //////////////////////////////////////////////////////////////////////
-GuiGLBuffer::GuiGLBuffer(IndexedLineSet* pIls, QColor& materialColor):
+GuiGLBuffer::GuiGLBuffer
+(IndexedLineSet* pIls, QColor& materialColor, const bool deferUpload):
   QOpenGLBuffer(),
+  _indexBuffer(QOpenGLBuffer::IndexBuffer),
   _nVertices(0),
   _nNormals(0),
   _nColors(0),
+  _nIndices(0),
   _hasFaces(false),
   _hasPolylines(false),
   _hasColor(false),
-  _hasNormal(false) {
+  _hasNormal(false),
+  _isIndexed(false),
+  _pIfs((IndexedFaceSet*)0),
+  _normalBinding(IndexedFaceSet::PB_NONE),
+  _colorBinding(IndexedFaceSet::PB_NONE),
+  _nCoordIndex(0),
+  _vertexUploaded(0),
+  _indexUploaded(0),
+  _uploaded(false) {
 
   // std::cout << "GuiGLBuffer::GuiGLBuffer(IndexedLineSet) {\n";
 
-  QVector<QVector3D> m_vertices;
-  QVector<QVector3D> m_normals;
-  QVector<QVector3D> m_colors;
-
   if(pIls==(IndexedLineSet*)0) return;
 
   vector<float>& coord          = pIls->getCoord();
@@ -285,49 +469,54 @@ GuiGLBuffer::GuiGLBuffer(IndexedLineSet* pIls, QColor& materialColor):
 
   _type = (_hasColor)?COLOR:MATERIAL;
 
-  m_vertices.clear();
-  m_normals.clear();
-  m_colors.clear();
+  // the interleaved coordinates and colors are written directly into
+  // _vertexData, which is sized from the number of vertices first
+  const int nPerVertex = (_hasColor)?6:3;
 
   if(_hasPolylines) {
 
-    float x[2][3];
-    float c[2][3];
-    int   j[2];
+    // two vertices per polyline edge
+    int i0,i1;
+    for(i0=i1=0;i1<(int)coordIndex.size();i1++) {
+      if(coordIndex[i1]<0) {
+        if(i1-i0>1) _nVertices += 2*(i1-i0-1);
+        i0 = i1+1;
+      }
+    }
+    _nColors = (_hasColor)?_nVertices:0;
+    _vertexData.resize((size_t)nPerVertex*_nVertices);
+    GLfloat* p = _vertexData.data();
 
-    int iC,iV,k,h,i0,i1,iP; // ,nPolylineEdges;
+    const float* c[2] = { (const float*)0, (const float*)0 };
+    int j[2];
+
+    int iC,iV,k,h,iP;
     for(iP=i0=i1=0;i1<(int)coordIndex.size();i1++) {
       if(coordIndex[i1]<0) {
-        // nPolylineEdges = i1-i0-1;
         if(_hasColor && colorPerVertex==false) {
           // get color index for this polyline
           iC = (colorIndex.size()>0)?colorIndex[iP]:iP;
           // assign the same color to the two vertices
-          for(h=0;h<3;h++)
-            c[0][h] = c[1][h] = color[3*iC+h];
+          c[0] = c[1] = &color[3*iC];
         }
 
         // for each edge in the polyline
         for(j[0]=i0,j[1]=i0+1;j[1]<i1;j[0]=j[1]++) {
-          // edge [j0,j1]
-          for(k=0;k<2;k++) {
-            // get vertex coordinates
+          // edge [j0,j1], pushed in reverse order
+          for(k=1;k>=0;k--) {
             iV = coordIndex[j[k]];
             for(h=0;h<3;h++)
-              x[k][h] = coord[3*iV+h];
-            // get color per vertex or per corner
-            if(_hasColor && colorPerVertex==true) {
-              iC = (colorIndex.size()>0)?colorIndex[j[k]]:iV;
+              *p++ = coord[3*iV+h];
+            if(_hasColor) {
+              // get color per vertex or per corner
+              if(colorPerVertex==true) {
+                iC = (colorIndex.size()>0)?colorIndex[j[k]]:iV;
+                c[k] = &color[3*iC];
+              }
               for(h=0;h<3;h++)
-                c[k][h] = color[3*iC+h];
+                *p++ = c[k][h];
             }
           }
-
-          // push values onto buffers
-          for(k=1;k>=0;k--) {
-            m_vertices.append(QVector3D(x[k][0],x[k][1],x[k][2]));
-            if(_hasColor) m_colors.append(QVector3D(c[k][0],c[k][1],c[k][2]));
-          }
         }
 
         // advance to next polyline
@@ -339,50 +528,23 @@ GuiGLBuffer::GuiGLBuffer(IndexedLineSet* pIls, QColor& materialColor):
 
     // treat as point cloud
 
-    unsigned iV,iC,nVertices;
-    nVertices = pIls->getNumberOfCoord();
-    float x[3];
-    float c[3];
-    for(iV=0;iV<nVertices;iV++) {
-      x[0] = coord[3*iV  ];
-      x[1] = coord[3*iV+1];
-      x[2] = coord[3*iV+2];
-      m_vertices.append(QVector3D(x[0],x[1],x[2]));
-      if(color.size()>0) {
+    unsigned iV,iC,h;
+    _nVertices = pIls->getNumberOfCoord();
+    _nColors   = (_hasColor)?_nVertices:0;
+    _vertexData.resize((size_t)nPerVertex*_nVertices);
+    GLfloat* p = _vertexData.data();
+    for(iV=0;iV<_nVertices;iV++) {
+      for(h=0;h<3;h++)
+        *p++ = coord[3*iV+h];
+      if(_hasColor) {
         iC = (colorIndex.size()>0)?colorIndex[iV]:iV;
-        c[0] = color[3*iC  ];
-        c[1] = color[3*iC+1];
-        c[2] = color[3*iC+2];
-        m_colors.append(QVector3D(c[0],c[1],c[2]));
+        for(h=0;h<3;h++)
+          *p++ = color[3*iC+h];
       }
     }
   }
 
-  _nVertices = m_vertices.count();
-  _nColors   = m_colors.count();
-
-  // Use a vertex buffer object.
-
-  this->create();
-  this->bind();
-  QVector<GLfloat> buf;
-  buf.resize(3*_nVertices+3*_nColors);
-
-  GLfloat *p = buf.data();
-  for (unsigned i = 0; i < _nVertices; ++i) {
-    // vertex coordinates
-    *p++ = m_vertices[i].x();
-    *p++ = m_vertices[i].y();
-    *p++ = m_vertices[i].z();
-    // vertex colors
-    if(_nColors>0) {
-      *p++ = m_colors[i].x();
-      *p++ = m_colors[i].y();
-      *p++ = m_colors[i].z();
-    }
-  }
-  this->allocate(buf.constData(), buf.count() * sizeof(GLfloat));
-  this->release();
+  if(deferUpload==false) upload();
 
   // std::cout << "  _nVertices    = " << _nVertices << "\n";
   // std::cout << "  _nNormals     = " << _nNormals << "\n";
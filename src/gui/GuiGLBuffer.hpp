@@ -39,6 +39,7 @@
 #include <QVector>
 #include <QVector3D>
 #include <QOpenGLBuffer>
+#include <vector>
 #include "wrl/IndexedFaceSet.hpp"
 #include "wrl/IndexedLineSet.hpp"
 
@@ -50,31 +51,84 @@ public:
     MATERIAL, MATERIAL_NORMAL, COLOR, COLOR_NORMAL
   };
 
+  // The vertex data is packed into memory by the constructors, which
+  // do not need an OpenGL context if deferUpload==true, and can then
+  // run in any thread; the data is then uploaded by upload(). Otherwise
+  // it is uploaded right away.
   GuiGLBuffer();
-  GuiGLBuffer(IndexedFaceSet* pIfs, QColor& materialColor);
-  GuiGLBuffer(IndexedLineSet* pIls, QColor& materialColor);
+  GuiGLBuffer(IndexedFaceSet* pIfs, QColor& materialColor,
+              const bool deferUpload=false);
+  GuiGLBuffer(IndexedLineSet* pIls, QColor& materialColor,
+              const bool deferUpload=false);
 
   Type     getType() const             { return                       _type; } 
   unsigned getNumberOfVertices() const { return                  _nVertices; }
   unsigned getNumberOfNormals()  const { return                   _nNormals; }
   unsigned getNumberOfColors()   const { return                    _nColors; }
+  unsigned getNumberOfIndices()  const { return                   _nIndices; }
 
   bool     hasFaces()            const { return                   _hasFaces; }
   bool     hasPolylines()        const { return               _hasPolylines; }
   bool     hasPoints()           const { return !(_hasFaces||_hasPolylines); }
   bool     hasColor()            const { return                   _hasColor; }
   bool     hasNormal()           const { return                  _hasNormal; }
+  // faces drawn with glDrawElements from getIndexBuffer()
+  bool     isIndexed()           const { return                  _isIndexed; }
+
+  QOpenGLBuffer& getIndexBuffer()      { return                _indexBuffer; }
+
+  // Upload at most maxBytes more of the packed data, or all of it if
+  // maxBytes==0, and return true once the whole data has been
+  // uploaded, when the packed data is released. Buffers are not drawn
+  // or updated before that. Must be called with the OpenGL context
+  // current.
+  bool     upload(const size_t maxBytes=0);
+  bool     isUploaded()          const { return                   _uploaded; }
+  // bytes of packed data still to be uploaded
+  size_t   getPendingBytes()     const {
+    return (_uploaded)?0:
+      _vertexData.size()*sizeof(GLfloat)+_indexData.size()*sizeof(GLuint)-
+      _vertexUploaded-_indexUploaded;
+  }
+
+  // Rewrite the vertices of the buffer affected by the changes recorded
+  // in the IndexedFaceSet (IndexedFaceSet::CHANGED_COORD, CHANGED_NORMAL
+  // and CHANGED_COLOR), with one glBufferSubData per run of consecutive
+  // changed vertices, and clear the changes. The element buffer is not
+  // rewritten, since moving vertices does not change the triangles.
+  // Returns false, leaving the buffer and the changes untouched, if the
+  // IndexedFaceSet no longer matches the layout of the buffer, as after
+  // a CHANGED_COORD_INDEX edit, and the buffer has to be rebuilt. Must
+  // be called with the OpenGL context current.
+  bool     update();
 
 protected:
 
+  QOpenGLBuffer _indexBuffer;
+
   Type     _type;
   unsigned _nVertices;
   unsigned _nNormals;
   unsigned _nColors;
+  unsigned _nIndices;
   bool     _hasFaces;
   bool     _hasPolylines;
   bool     _hasColor;
   bool     _hasNormal;
+  bool     _isIndexed;
+
+  // source of a buffer built from an IndexedFaceSet, and its layout
+  IndexedFaceSet*         _pIfs;
+  IndexedFaceSet::Binding _normalBinding;
+  IndexedFaceSet::Binding _colorBinding;
+  unsigned                _nCoordIndex;
+
+  // packed data, until uploaded, and bytes of it already uploaded
+  std::vector<GLfloat>    _vertexData;
+  std::vector<GLuint>     _indexData;
+  size_t                  _vertexUploaded;
+  size_t                  _indexUploaded;
+  bool                    _uploaded;
 
 };
 
@@ -110,19 +110,73 @@ const char *GuiGLShader::s_fsColor =
   "  gl_FragColor = color;\n"
   "}\n";
 
+//////////////////////////////////////////////////////////////////////
+// Shader program for one GuiGLBuffer::Type, and the locations of its
+// variables. The shaders are added as cacheable, so that Qt saves the
+// linked program binary in its shader disk cache, where supported by
+// the driver, and later runs load it instead of compiling the sources.
+class GuiGLShader::Program {
+
+public:
+
+  QOpenGLShaderProgram program;
+
+  int pointSizeAttr;
+  int lineWidthAttr;
+  int vertexAttr;
+  int normalAttr;
+  int colorAttr;
+  int mvpMatrixAttr;
+  int materialAttr;
+  int lightSourceAttr;
+
+  Program(const GuiGLBuffer::Type type) {
+    const char* vs = s_vsMaterial;
+    switch(type) {
+    case GuiGLBuffer::Type::MATERIAL:        vs = s_vsMaterial;        break;
+    case GuiGLBuffer::Type::MATERIAL_NORMAL: vs = s_vsMaterialNormal;  break;
+    case GuiGLBuffer::Type::COLOR:           vs = s_vsColor;           break;
+    case GuiGLBuffer::Type::COLOR_NORMAL:    vs = s_vsColorNormal;     break;
+    }
+    program.addCacheableShaderFromSourceCode(QOpenGLShader::Vertex,vs);
+    program.addCacheableShaderFromSourceCode(QOpenGLShader::Fragment,s_fsColor);
+    program.link();
+
+    // the locations of the variables not used by the program are -1
+    pointSizeAttr   = program.uniformLocation("pointsize");
+    lineWidthAttr   = program.uniformLocation("linewidth");
+    vertexAttr      = program.attributeLocation("vertex");
+    normalAttr      = program.attributeLocation("vnormal");
+    colorAttr       = program.attributeLocation("vcolor");
+    mvpMatrixAttr   = program.uniformLocation("mvpmatrix");
+    materialAttr    = program.uniformLocation("matcolor");
+    lightSourceAttr = program.uniformLocation("lightsource");
+  }
+
+};
+
+GuiGLShader::Program* GuiGLShader::s_program[4] = {
+  (GuiGLShader::Program*)0, (GuiGLShader::Program*)0,
+  (GuiGLShader::Program*)0, (GuiGLShader::Program*)0
+};
+
+//////////////////////////////////////////////////////////////////////
+GuiGLShader::Program* GuiGLShader::getProgram(const GuiGLBuffer::Type type) {
+  if(s_program[type]==(Program*)0) s_program[type] = new Program(type);
+  return s_program[type];
+}
+
+//////////////////////////////////////////////////////////////////////
+void GuiGLShader::deletePrograms() {
+  for(int i=0;i<4;i++) {
+    delete s_program[i];
+    s_program[i] = (Program*)0;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////
 GuiGLShader::GuiGLShader(QColor& materialColor, QVector3D* lightSource):
-  _vshader((QOpenGLShader*)0),
-  _fshader((QOpenGLShader*)0),
-  _program((QOpenGLShaderProgram*)0),
-  _pointSizeAttr(-1),
-  _lineWidthAttr(-1),
-  _vertexAttr(-1),
-  _normalAttr(-1),
-  _colorAttr(-1),
-  _mvpMatrixAttr(-1),
-  _materialAttr(-1),
-  _lightSourceAttr(-1),
+  _program((Program*)0),
   _vertexBuffer((GuiGLBuffer*)0),
   _materialColor(materialColor),
   _lightSource(lightSource),
@@ -133,9 +187,6 @@ GuiGLShader::GuiGLShader(QColor& materialColor, QVector3D* lightSource):
 
 //////////////////////////////////////////////////////////////////////
 GuiGLShader::~GuiGLShader() {
-  delete _program;
-  delete _vshader;
-  delete _fshader;
   if(_vertexBuffer==(GuiGLBuffer*)0) return;
   _vertexBuffer->destroy();
   delete _vertexBuffer;
@@ -174,104 +225,48 @@ GuiGLBuffer* GuiGLShader::getVertexBuffer() const {
 
 //////////////////////////////////////////////////////////////////////
 void GuiGLShader::setVertexBuffer(GuiGLBuffer* vb) {
-
   _vertexBuffer = vb;
-  if(_vertexBuffer==(GuiGLBuffer*)0) return;
-
-  GuiGLBuffer::Type type = _vertexBuffer->getType();
-
-  // int nVertices =  _vertexBuffer->getNumberOfVertices();
-  // int nNormals  =  _vertexBuffer->getNumberOfNormals();
-  // int nColors   =  _vertexBuffer->getNumberOfColors();
-
-  // create the vertex shader
-  _vshader = new QOpenGLShader(QOpenGLShader::Vertex);
-  switch(type) {
-  case GuiGLBuffer::Type::MATERIAL:
-    _vshader->compileSourceCode(s_vsMaterial);
-    break;
-  case GuiGLBuffer::Type::MATERIAL_NORMAL:
-    _vshader->compileSourceCode(s_vsMaterialNormal);
-    break;
-  case GuiGLBuffer::Type::COLOR:
-    _vshader->compileSourceCode(s_vsColor);
-    break;
-  case GuiGLBuffer::Type::COLOR_NORMAL:
-    _vshader->compileSourceCode(s_vsColorNormal);
-    break;
-  }
-
-  // create the fragment shader
-  _fshader = new QOpenGLShader(QOpenGLShader::Fragment);
-  _fshader->compileSourceCode(s_fsColor);
-
-  // create the shader program
-  _program = new QOpenGLShaderProgram;
-  _program->addShader(_vshader);
-  _program->addShader(_fshader);
-  _program->link();
-
-  _pointSizeAttr       = -1;
-  _lineWidthAttr       = -1;
-  _vertexAttr          = -1;
-  _normalAttr          = -1;
-  _colorAttr           = -1;
-  _mvpMatrixAttr       = -1;
-  _materialAttr        = -1;
-  _lightSourceAttr     = -1;
-
-  _pointSizeAttr         = _program->uniformLocation("pointsize");
-  _lineWidthAttr         = _program->uniformLocation("linewidth");
-  _vertexAttr            = _program->attributeLocation("vertex");
-  switch(type) {
-  case GuiGLBuffer::Type::MATERIAL:
-    _materialAttr        = _program->uniformLocation("matcolor");
-    break;
-  case GuiGLBuffer::Type::MATERIAL_NORMAL:
-    _materialAttr        = _program->uniformLocation("matcolor");
-    _normalAttr          = _program->attributeLocation("vnormal");
-    break;
-  case GuiGLBuffer::Type::COLOR:
-    _colorAttr           = _program->attributeLocation("vcolor");
-    break;
-  case GuiGLBuffer::Type::COLOR_NORMAL:
-    _colorAttr           = _program->attributeLocation("vcolor");
-    _normalAttr          = _program->attributeLocation("vnormal");
-    break;
-  }
-  _mvpMatrixAttr         = _program->uniformLocation("mvpmatrix");
-  _lightSourceAttr       = _program->uniformLocation("lightsource");
+  _program      =
+    (_vertexBuffer!=(GuiGLBuffer*)0)?
+    getProgram(_vertexBuffer->getType()):(Program*)0;
 }
-
+
 //////////////////////////////////////////////////////////////////////
 void GuiGLShader::paint(QOpenGLFunctions& f) {
 
-  if(_vertexBuffer==(GuiGLBuffer*)0) return;
+  if(_vertexBuffer==(GuiGLBuffer*)0 || _program==(Program*)0) return;
 
-  GuiGLBuffer::Type type = _vertexBuffer->getType();
+  GuiGLBuffer::Type     type           = _vertexBuffer->getType();
+  QOpenGLShaderProgram* program        = &(_program->program);
+  int                   vertexAttr     = _program->vertexAttr;
+  int                   normalAttr     = _program->normalAttr;
+  int                   colorAttr      = _program->colorAttr;
+  int                   materialAttr   = _program->materialAttr;
 
-  _program->bind();
+  // the program is shared, so all of its uniforms are set every time
+  program->bind();
 
-  _program->setUniformValue(_mvpMatrixAttr, _mvpMatrix);
-  _program->setUniformValue(_lightSourceAttr, *_lightSource);
+  program->setUniformValue(_program->mvpMatrixAttr, _mvpMatrix);
+  if(_lightSource!=(QVector3D*)0)
+    program->setUniformValue(_program->lightSourceAttr, *_lightSource);
 
-  _program->setUniformValue(_pointSizeAttr, _pointSize);
-  _program->setUniformValue(_lineWidthAttr, _lineWidth);
-  _program->enableAttributeArray(_vertexAttr);
+  program->setUniformValue(_program->pointSizeAttr, _pointSize);
+  program->setUniformValue(_program->lineWidthAttr, _lineWidth);
+  program->enableAttributeArray(vertexAttr);
   switch(type) {
   case GuiGLBuffer::Type::MATERIAL:
-    _program->setUniformValue(_materialAttr, _materialColor);
+    program->setUniformValue(materialAttr, _materialColor);
     break;
   case GuiGLBuffer::Type::MATERIAL_NORMAL:
-    _program->setUniformValue(_materialAttr, _materialColor);
-    _program->enableAttributeArray(_normalAttr);
+    program->setUniformValue(materialAttr, _materialColor);
+    program->enableAttributeArray(normalAttr);
     break;
   case GuiGLBuffer::Type::COLOR:
-    _program->enableAttributeArray(_colorAttr);
+    program->enableAttributeArray(colorAttr);
     break;
   case GuiGLBuffer::Type::COLOR_NORMAL:
-    _program->enableAttributeArray(_colorAttr);
-    _program->enableAttributeArray(_normalAttr);
+    program->enableAttributeArray(colorAttr);
+    program->enableAttributeArray(normalAttr);
     break;
   }
   
@@ -279,35 +274,41 @@ void GuiGLShader::paint(QOpenGLFunctions& f) {
 
   switch(type) {
   case GuiGLBuffer::Type::MATERIAL:
-    _program->setAttributeBuffer
-      (_vertexAttr, GL_FLOAT,                 0, 3, 3*sizeof(GLfloat));
+    program->setAttributeBuffer
+      (vertexAttr, GL_FLOAT,                 0, 3, 3*sizeof(GLfloat));
     break;
   case GuiGLBuffer::Type::MATERIAL_NORMAL:
-    _program->setAttributeBuffer
-      (_vertexAttr, GL_FLOAT,                 0, 3, 6*sizeof(GLfloat));
-    _program->setAttributeBuffer
-      (_normalAttr, GL_FLOAT, 3*sizeof(GLfloat), 3, 6*sizeof(GLfloat));
+    program->setAttributeBuffer
+      (vertexAttr, GL_FLOAT,                 0, 3, 6*sizeof(GLfloat));
+    program->setAttributeBuffer
+      (normalAttr, GL_FLOAT, 3*sizeof(GLfloat), 3, 6*sizeof(GLfloat));
     break;
   case GuiGLBuffer::Type::COLOR:
-    _program->setAttributeBuffer
-      (_vertexAttr, GL_FLOAT,                 0, 3, 6*sizeof(GLfloat));
-    _program->setAttributeBuffer
-      ( _colorAttr, GL_FLOAT, 3*sizeof(GLfloat), 3, 6*sizeof(GLfloat));
+    program->setAttributeBuffer
+      (vertexAttr, GL_FLOAT,                 0, 3, 6*sizeof(GLfloat));
+    program->setAttributeBuffer
+      ( colorAttr, GL_FLOAT, 3*sizeof(GLfloat), 3, 6*sizeof(GLfloat));
     break;
   case GuiGLBuffer::Type::COLOR_NORMAL:
-    _program->setAttributeBuffer
-      (_vertexAttr, GL_FLOAT,                 0, 3, 9*sizeof(GLfloat));
-    _program->setAttributeBuffer
-      (_normalAttr, GL_FLOAT, 3*sizeof(GLfloat), 3, 9*sizeof(GLfloat));
-    _program->setAttributeBuffer
-      ( _colorAttr, GL_FLOAT, 6*sizeof(GLfloat), 3, 9*sizeof(GLfloat));
+    program->setAttributeBuffer
+      (vertexAttr, GL_FLOAT,                 0, 3, 9*sizeof(GLfloat));
+    program->setAttributeBuffer
+      (normalAttr, GL_FLOAT, 3*sizeof(GLfloat), 3, 9*sizeof(GLfloat));
+    program->setAttributeBuffer
+      ( colorAttr, GL_FLOAT, 6*sizeof(GLfloat), 3, 9*sizeof(GLfloat));
     break;
   }
 
   _vertexBuffer->release();
 
   int nVertices =  getNumberOfVertices();
-  if(_vertexBuffer->hasFaces()) {
+  if(_vertexBuffer->hasFaces() && _vertexBuffer->isIndexed()) {
+    QOpenGLBuffer& indexBuffer = _vertexBuffer->getIndexBuffer();
+    indexBuffer.bind();
+    f.glDrawElements(GL_TRIANGLES, _vertexBuffer->getNumberOfIndices(),
+                     GL_UNSIGNED_INT, (const void*)0);
+    indexBuffer.release();
+  } else if(_vertexBuffer->hasFaces()) {
     f.glDrawArrays(GL_TRIANGLES, 0, nVertices);
   } else if(_vertexBuffer->hasPolylines()) {
     // TODO : move lineWidth to the vertex shader
@@ -317,21 +318,21 @@ void GuiGLShader::paint(QOpenGLFunctions& f) {
     f.glDrawArrays(GL_POINTS, 0, nVertices);
   }
 
-  _program->disableAttributeArray(_vertexAttr);
+  program->disableAttributeArray(vertexAttr);
   switch(type) {
   case GuiGLBuffer::Type::MATERIAL:
     break;
   case GuiGLBuffer::Type::MATERIAL_NORMAL:
-    _program->disableAttributeArray(_normalAttr);
+    program->disableAttributeArray(normalAttr);
     break;
   case GuiGLBuffer::Type::COLOR:
-    _program->disableAttributeArray(_colorAttr);
+    program->disableAttributeArray(colorAttr);
     break;
   case GuiGLBuffer::Type::COLOR_NORMAL:
-    _program->disableAttributeArray(_colorAttr);
-    _program->disableAttributeArray(_normalAttr);
+    program->disableAttributeArray(colorAttr);
+    program->disableAttributeArray(normalAttr);
     break;
   }
 
-  _program->release();
+  program->release();
 }
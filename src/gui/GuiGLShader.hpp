@@ -53,8 +53,18 @@ private:
   static const char *s_vsColorNormal;
   static const char *s_fsColor;
 
+  // programs shared by all the shaders, one per GuiGLBuffer::Type,
+  // created when first needed
+  class Program;
+  static Program    *s_program[4];
+  static Program    *getProgram(const GuiGLBuffer::Type type);
+
 public:
 
+  // deletes the shared programs; must be called with the OpenGL
+  // context current, before the context is destroyed
+  static void    deletePrograms();
+
   // constructor for IndexedFaceSet : lightSource!=(QVector3D*)0
   // constructor for IndexedLineSet : lightSource==(QVector3D*)0
 
@@ -75,18 +85,7 @@ public:
 
 private:
 
-  QOpenGLShader        *_vshader;
-  QOpenGLShader        *_fshader;
-  QOpenGLShaderProgram *_program;
-
-  int                   _pointSizeAttr;
-  int                   _lineWidthAttr;
-  int                   _vertexAttr;
-  int                   _normalAttr;
-  int                   _colorAttr;
-  int                   _mvpMatrixAttr ;
-  int                   _materialAttr;
-  int                   _lightSourceAttr;
+  Program              *_program;
 
   GuiGLBuffer          *_vertexBuffer;
   QColor                _materialColor;
@@ -35,18 +35,24 @@
 #include <iostream>
 #include <string.h>
 #include <math.h>
+#include <float.h>
+#include <chrono>
+#include <map>
 
 #include <QPainter>
 #include <QPaintEngine>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLTexture>
 #include <QCoreApplication>
+#include <QElapsedTimer>
 
 #include "GuiMainWindow.hpp"
 #include "GuiQtLogo.hpp"
 #include "GuiGLBuffer.hpp"
 
 #include "wrl/SceneGraphTraversal.hpp"
+#include "wrl/SceneGraphProcessor.hpp"
+#include "util/ThreadPool.hpp"
 
 #ifdef near
 # undef near
@@ -98,7 +104,15 @@ GuiGLWidget::GuiGLWidget(QWidget* parent):
   _fAngle(0),
   _background(qRgb(200,200,200)),
   _material(qRgb(225,150,75)),
-  _lightSource(0.0, 0.3, -1.0) {
+  _lightSource(0.0, 0.3, -1.0),
+  _renderParent(0),
+  _uploadPacked(0),
+  _uploadDone(0),
+  _uploadBudget(10),
+  _packDone(false),
+  _frustumCulling(true),
+  _nShapesDrawn(0),
+  _nShapesCulled(0) {
   (void)parent;
 
   setMinimumSize(400,400);
@@ -111,26 +125,25 @@ GuiGLWidget::GuiGLWidget(QWidget* parent):
 
 //////////////////////////////////////////////////////////////////////
 GuiGLWidget::~GuiGLWidget() {
+  _finishPacking();
   makeCurrent();
-  map<Shape*,GuiGLShader*>::iterator i;
-  for(i=_shaderMap.begin();i!=_shaderMap.end();i++) {
-    // Shape* shape = i->first;
-    GuiGLShader* shader = i->second;
-    i->second = (GuiGLShader*)0;
-    delete shader;
-  }
-  _shaderMap.clear();
+  _clearRenderList();
+  GuiGLShader::deletePrograms();
   delete _handles;
   doneCurrent();
 }
 
 //////////////////////////////////////////////////////////////////////
+// The caller may modify the scene graph, which the packing thread may
+// be reading; it is handed out once the thread is done.
 GuiViewerData& GuiGLWidget::getData() {
+  _finishPacking();
   return _data;
 }
 
 //////////////////////////////////////////////////////////////////////
 SceneGraph* GuiGLWidget::getSceneGraph() {
+  _finishPacking();
   return _data.getSceneGraph();
 }
 
@@ -140,104 +153,41 @@ void GuiGLWidget::setSceneGraph(SceneGraph* pWrl, bool resetHomeView) {
 
   // pWrl->printInfo("  ");
 
-  // cout << "  _shaderMap.size() = "<< _shaderMap.size() <<"\n";
-  // cout << "  deleting old shaders ... \n";
-  map<Shape*,GuiGLShader*>::iterator i;
-  for(i=_shaderMap.begin();i!=_shaderMap.end();i++) {
-    Shape* shape = i->first;
-    cout << "    found Shape \"" << shape->getName() << "\"\n";
-    GuiGLShader* shader = i->second;
-    i->second = (GuiGLShader*)0;
-    delete shader;
+  // when the scene graph is rebuilt after a structural change, the
+  // Shapes with an IndexedFaceSet geometry which are still in it keep
+  // their shaders, since the edits of their geometry are recorded as
+  // changes; the others, whose geometry may have been edited in place,
+  // are built again
+  map<Node*,RenderItem> kept;
+  _finishPacking();
+  if(pWrl!=(SceneGraph*)0 && pWrl==_data.getSceneGraph()) {
+    for(size_t s=0;s<_shapeItems.size();s++) {
+      RenderItem& item = _renderList[_shapeItems[s]];
+      if(item.shader==(GuiGLShader*)0 || item.faces==(IndexedFaceSet*)0)
+        continue;
+      kept[item.node] = item;
+      item.shader = (GuiGLShader*)0;
+    }
   }
-  _shaderMap.clear();
 
-  // cout << "  _shaderMap.size() = "<< _shaderMap.size() <<"\n";
+  _clearRenderList();
 
   _data.setSceneGraph(pWrl);
   if(pWrl!=(SceneGraph*)0) {
 
-    // cout << "  creating new shaders ... \n";
-
-    SceneGraphTraversal sgt(*pWrl);
-    sgt.start();
-    Node* node=(Node*)0;
-    while((node=sgt.next())!=(Node*)0) {
-      if(Shape* shape = dynamic_cast<Shape*>(node)) {
-
-        // cout << "    found Shape \"" << shape->getName() << "\"\n";
-        
-        QColor materialColor(255,150,90);
-
-        // cout << "      default materialColor = ("
-        //      << materialColor.red()   << ","
-        //      << materialColor.green() << ","
-        //      << materialColor.blue()  << ")\n";
-
-        node = shape->getAppearance();
-        if(Appearance* appearance = dynamic_cast<Appearance*>(node)) {
-          
-          // cout << "      has Appearance\n";
-
-          node = appearance->getMaterial();
-          if(Material* material = dynamic_cast<Material*>(node)) {
-            
-            // cout << "        has Material\n";
-
-            Color& diffuseColor = material->getDiffuseColor();
-            materialColor.setRedF(diffuseColor.r);
-            materialColor.setGreenF(diffuseColor.g);
-            materialColor.setBlueF(diffuseColor.b);
-
-            // cout << "          diffuseColor = ("
-            //      << materialColor.red()   << ","
-            //      << materialColor.green() << ","
-            //      << materialColor.blue()  << ")\n";
-          }
-        }
-
-        node = shape->getGeometry();
-        if(IndexedFaceSet* pIfs = dynamic_cast<IndexedFaceSet*>(node)) {
-
-          // cout << "      has geometry IndexedFaceSet\n";
-          // cout << "      creating shader ... \n";
-          // cout << "      lightSource = ( "
-          //      << _lightSource.x() << " , "
-          //      << _lightSource.y() << " , "
-          //      << _lightSource.z() <<" )\n";
-          // cout << "      materialColor = ( "
-          //      << materialColor.red() << " , "
-          //      << materialColor.green() << " , "
-          //      << materialColor.blue() <<" )\n";
-
-          GuiGLBuffer* ifsb   = new GuiGLBuffer(pIfs, materialColor);
-          GuiGLShader* shader = new GuiGLShader(materialColor,&_lightSource);
-          shader->setVertexBuffer(ifsb);
-          _shaderMap[shape] = shader;
-
-        } else if(IndexedLineSet* pIls = dynamic_cast<IndexedLineSet*>(node)) {
-
-          // cout << "      has geometry IndexedLineSet\n";
-          // cout << "      creating shader ... \n";
-          // cout << "      materialColor = ( "
-          //      << materialColor.red() << " , "
-          //      << materialColor.green() << " , "
-          //      << materialColor.blue() <<" )\n";
-
-          GuiGLBuffer* ifsb   = new GuiGLBuffer(pIls, materialColor);
-          GuiGLShader* shader = new GuiGLShader(materialColor);
-          shader->setVertexBuffer(ifsb);
-          _shaderMap[shape] = shader;
-
-        }
-
-      }
-    }
+    // the shaders are created by paintGL, a few shapes per frame
+    QMatrix4x4 model;
+    model.setToIdentity();
+    _addRenderItems(pWrl,model);
+    _reuseShaders(kept);
 
-    // cout << "  _shaderMap.size() = "<< _shaderMap.size() <<"\n";
+    // cout << "  _renderList.size() = "<< _renderList.size() <<"\n";
 
     if(resetHomeView) {
 
+      // computed once, and cached by the scene graph afterwards
+      pWrl->updateBBox();
+
       _bboxDiameter = 2.0f;
       if(pWrl->hasEmptyBBox()) {
         cout << "  hasEmptyBBox\n";
@@ -250,7 +200,10 @@ void GuiGLWidget::setSceneGraph(SceneGraph* pWrl, bool resetHomeView) {
         _center.setX(bbCenter.x);
         _center.setY(bbCenter.y);
         _center.setZ(bbCenter.z);
-        _bboxDiameter = pWrl->getBBoxDiameter();
+        // a single point, or points all at the same place, have a
+        // non-empty box of zero diameter, which keeps the default one
+        if(pWrl->getBBoxDiameter()>0.0f)
+          _bboxDiameter = pWrl->getBBoxDiameter();
       }
 
       // cout << "  center   = ("
@@ -266,52 +219,408 @@ void GuiGLWidget::setSceneGraph(SceneGraph* pWrl, bool resetHomeView) {
 
   }
 
+  // the Shapes removed from the scene graph
+  map<Node*,RenderItem>::iterator i;
+  for(i=kept.begin();i!=kept.end();i++)
+    delete i->second.shader;
+
   cout << "}\n";
 }
 
 //////////////////////////////////////////////////////////////////////
-void GuiGLWidget::setQtLogo() {
-  SceneGraph* wrl = new GuiQtLogo();
-  _data.setSceneGraph(wrl);
-  _mainWindow->updateState();
+// Gives the shaders kept by setSceneGraph back to the Shapes of the
+// new render list, and removes them from the map. The pointers in the
+// map are only compared, as the nodes may have been deleted. The
+// Shapes with a complete buffer are moved to the front of _shapeItems,
+// followed by those whose buffer is still being uploaded.
+void GuiGLWidget::_reuseShaders(map<Node*,RenderItem>& kept) {
+  vector<unsigned> uploaded,packed,pending;
+  for(size_t s=0;s<_shapeItems.size();s++) {
+    RenderItem& item = _renderList[_shapeItems[s]];
+    map<Node*,RenderItem>::iterator i = kept.find(item.node);
+    if(i!=kept.end() && i->second.faces==item.faces) {
+      item.shader = i->second.shader;
+      kept.erase(i);
+    }
+    GuiGLBuffer* vbo =
+      (item.shader!=(GuiGLShader*)0)?
+      item.shader->getVertexBuffer():(GuiGLBuffer*)0;
+    if(item.shader==(GuiGLShader*)0)
+      pending.push_back(_shapeItems[s]);
+    else if(vbo==(GuiGLBuffer*)0 || vbo->isUploaded())
+      uploaded.push_back(_shapeItems[s]);
+    else
+      packed.push_back(_shapeItems[s]);
+  }
+  _uploadDone   = uploaded.size();
+  _uploadPacked = uploaded.size()+packed.size();
+  _shapeItems.swap(uploaded);
+  _shapeItems.insert(_shapeItems.end(),packed.begin(),packed.end());
+  _shapeItems.insert(_shapeItems.end(),pending.begin(),pending.end());
+}
+
+//////////////////////////////////////////////////////////////////////
+// Diffuse color of the Material of a Shape, or a default color.
+static QColor getMaterialColor(Shape* shape) {
+
+  QColor materialColor(255,150,90);
+
+  Node* node = shape->getAppearance();
+  if(Appearance* appearance = dynamic_cast<Appearance*>(node)) {
+    node = appearance->getMaterial();
+    if(Material* material = dynamic_cast<Material*>(node)) {
+      Color& diffuseColor = material->getDiffuseColor();
+      materialColor.setRedF(diffuseColor.r);
+      materialColor.setGreenF(diffuseColor.g);
+      materialColor.setBlueF(diffuseColor.b);
+    }
+  }
+
+  return materialColor;
 }
 
 //////////////////////////////////////////////////////////////////////
-void GuiGLWidget::invertNormal() {
+// Vertex buffer of a Shape with an IndexedFaceSet or an IndexedLineSet
+// geometry; returns null for other shapes. If deferUpload==true, no
+// OpenGL calls are made, and it can be called from any thread.
+static GuiGLBuffer* createVertexBuffer(Shape* shape, const bool deferUpload) {
+  QColor materialColor = getMaterialColor(shape);
+  Node*  node          = shape->getGeometry();
+  if(IndexedFaceSet* pIfs = dynamic_cast<IndexedFaceSet*>(node))
+    return new GuiGLBuffer(pIfs,materialColor,deferUpload);
+  else if(IndexedLineSet* pIls = dynamic_cast<IndexedLineSet*>(node))
+    return new GuiGLBuffer(pIls,materialColor,deferUpload);
+  return (GuiGLBuffer*)0;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Shader of a Shape with an IndexedFaceSet or an IndexedLineSet
+// geometry, drawing the given vertex buffer, or a new one if
+// vbo==null; returns null for other shapes.
+GuiGLShader* GuiGLWidget::_createShader(Shape* shape, GuiGLBuffer* vbo) {
+
+  if(vbo==(GuiGLBuffer*)0) vbo = createVertexBuffer(shape,false);
+  if(vbo==(GuiGLBuffer*)0) return (GuiGLShader*)0;
+
+  // only the faces are lit
+  QColor       materialColor = getMaterialColor(shape);
+  GuiGLShader* shader        =
+    (dynamic_cast<IndexedFaceSet*>(shape->getGeometry()))?
+    new GuiGLShader(materialColor,&_lightSource):
+    new GuiGLShader(materialColor);
+  shader->setVertexBuffer(vbo);
+  return shader;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Cost of packing the vertex buffer of a Shape, in coordinate indices,
+// or vertices for point sets.
+static size_t getPackingCost(Shape* shape) {
+  Node* node = shape->getGeometry();
+  if(IndexedFaceSet* pIfs = dynamic_cast<IndexedFaceSet*>(node))
+    return pIfs->getCoordIndex().size();
+  else if(IndexedLineSet* pIls = dynamic_cast<IndexedLineSet*>(node))
+    return pIls->getCoordIndex().size()+(size_t)pIls->getNumberOfCoord();
+  return 0;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Starts packing the vertex buffers of the next Shapes in a worker
+// thread. Small Shapes are packed together, one per ThreadPool task;
+// a large one is packed by itself, outside of any task, so that the
+// GuiGLBuffer constructor can split it among all the threads.
+void GuiGLWidget::_startPacking() {
+  const size_t   largeShape = 1<<16;
+  vector<Shape*> shapes;
+  size_t         cost = 0;
+  while(_uploadPacked+shapes.size()<_shapeItems.size() && cost<largeShape) {
+    unsigned k = _shapeItems[_uploadPacked+shapes.size()];
+    Shape*   shape = (Shape*)_renderList[k].node;
+    size_t   c     = getPackingCost(shape);
+    if(c>=largeShape && shapes.size()>0) break;
+    // the coordinates may have changed since the last frame
+    _updateShapeBBox(k);
+    shapes.push_back(shape);
+    cost += c;
+  }
+  _packed.assign(shapes.size(),(GuiGLBuffer*)0);
+  _packDone = false;
+  _packThread = thread([this,shapes]() {
+      int n = (int)shapes.size();
+      if(n==1) {
+        _packed[0] = createVertexBuffer(shapes[0],true);
+      } else {
+        ThreadPool::getInstance().run(n,[&](int i) {
+            _packed[i] = createVertexBuffer(shapes[i],true);
+          });
+      }
+      _packDone = true;
+    });
+}
+
+//////////////////////////////////////////////////////////////////////
+// Waits for the packing thread, if running, and creates the shaders
+// of the Shapes whose buffers it has packed.
+void GuiGLWidget::_finishPacking() {
+  if(_packThread.joinable()==false) return;
+  _packThread.join();
+  for(size_t i=0;i<_packed.size();i++) {
+    RenderItem& item = _renderList[_shapeItems[_uploadPacked+i]];
+    item.shader = _createShader((Shape*)item.node,_packed[i]);
+  }
+  _uploadPacked += _packed.size();
+  _packed.clear();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Uploads the vertex buffers of the shapes queued by setSceneGraph, in
+// slices of a few megabytes, for about _uploadBudget milliseconds. The
+// buffers are packed by a worker thread, one batch ahead, and polled
+// here; a shape is drawn as soon as its buffer is complete.
+void GuiGLWidget::_upload() {
+
+  if(isUploading()==false) return;
+
+  const size_t  maxBytes = 1<<22;
+  QElapsedTimer timer;
+  timer.start();
+
+  while(isUploading() && timer.elapsed()<_uploadBudget) {
+    if(_packThread.joinable() && _packDone)
+      _finishPacking();
+    if(_packThread.joinable()==false && _uploadPacked<_shapeItems.size())
+      _startPacking();
+    if(_uploadDone<_uploadPacked) {
+      GuiGLShader* shader = _renderList[_shapeItems[_uploadDone]].shader;
+      GuiGLBuffer* vbo    =
+        (shader!=(GuiGLShader*)0)?shader->getVertexBuffer():(GuiGLBuffer*)0;
+      if(vbo==(GuiGLBuffer*)0 || vbo->upload(maxBytes))
+        _uploadDone++;
+    } else {
+      // nothing to upload until the current batch is packed
+      this_thread::sleep_for(chrono::milliseconds(1));
+    }
+  }
+
+  // continue in the next frame
+  if(isUploading()) update();
+}
+
+//////////////////////////////////////////////////////////////////////
+// bounding boxes stored as min[3] and max[3], empty if min>max
+
+static void setEmptyBBox(float* min, float* max) {
+  min[0] = min[1] = min[2] =  FLT_MAX;
+  max[0] = max[1] = max[2] = -FLT_MAX;
+}
+
+static void addBBox(float* min, float* max,
+                    const float* bMin, const float* bMax) {
+  for(int i=0;i<3;i++) {
+    if(bMin[i]<min[i]) min[i] = bMin[i];
+    if(bMax[i]>max[i]) max[i] = bMax[i];
+  }
+}
+
+// bounding box of the coordinates of the geometry of a Shape, mapped
+// to world space by the model matrix; the box in the coordinates of
+// the Shape is cached by the Shape itself
+static void getShapeBBox(Shape* shape, const QMatrix4x4& model,
+                         float* min, float* max) {
+  setEmptyBBox(min,max);
+  Vec3f vMin,vMax;
+  if(shape->getBBox(vMin,vMax)==false) return;
+  float bMin[3] = { vMin.x, vMin.y, vMin.z };
+  float bMax[3] = { vMax.x, vMax.y, vMax.z };
+
+  // the box centered at model*center, with the half sides given by
+  // the absolute values of the entries of the model matrix
+  for(int i=0;i<3;i++) {
+    float c = model(i,3);
+    float e = 0.0f;
+    for(int j=0;j<3;j++) {
+      c += model(i,j)*0.5f*(bMin[j]+bMax[j]);
+      e += fabsf(model(i,j))*0.5f*(bMax[j]-bMin[j]);
+    }
+    min[i] = c-e;
+    max[i] = c+e;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+// Planes bounding the view volume of a model-view-projection matrix,
+// as a*x+b*y+c*z+d>=0, and classification of bounding boxes against
+// them.
+class Frustum {
 
-  map<Shape*,GuiGLShader*>::iterator i;
-  for(i=_shaderMap.begin();i!=_shaderMap.end();i++) {
-    Shape*         shape    = i->first;
-    GuiGLShader*   shader   = i->second;
-    GuiGLBuffer*   vbo      = shader->getVertexBuffer();
+public:
 
-    Node* geometry = shape->getGeometry();
-    if(IndexedFaceSet* ifs=dynamic_cast<IndexedFaceSet*>(geometry)) {
+  enum { OUTSIDE, INTERSECTING, INSIDE };
 
-      vector<float> &normal = ifs->getNormal();    
-      float n0,n1,n2;
-      for(unsigned i=0;i<normal.size();i+=3) {
-        n0 = normal[i+0]; n1 = normal[i+1]; n2 = normal[i+2];
-        normal[i+0] = -n0; normal[i+1] = -n1; normal[i+2] = -n2;
+  Frustum(const QMatrix4x4& mvp) {
+    for(int i=0;i<3;i++) {
+      for(int j=0;j<4;j++) {
+        _plane[2*i  ][j] = mvp(3,j)+mvp(i,j);
+        _plane[2*i+1][j] = mvp(3,j)-mvp(i,j);
       }
+    }
+  }
 
-      QColor materialColor(255,150,90);
-      if(Appearance* appearance =
-         dynamic_cast<Appearance*>(shape->getAppearance())) {
-        if(Material* material =
-           dynamic_cast<Material*>(appearance->getMaterial())) {
-          Color& diffuseColor = material->getDiffuseColor();
-          materialColor.setRedF(diffuseColor.r);
-          materialColor.setGreenF(diffuseColor.g);
-          materialColor.setBlueF(diffuseColor.b);
-        }
+  int test(const float* min, const float* max) const {
+    if(min[0]>max[0]) return OUTSIDE;
+    int result = INSIDE;
+    for(int k=0;k<6;k++) {
+      const float* p = _plane[k];
+      // the corners farthest along and against the normal
+      float dMax = p[3], dMin = p[3];
+      for(int i=0;i<3;i++) {
+        dMax += p[i]*((p[i]>0.0f)?max[i]:min[i]);
+        dMin += p[i]*((p[i]>0.0f)?min[i]:max[i]);
       }
+      if(dMax<0.0f) return OUTSIDE;
+      if(dMin<0.0f) result = INTERSECTING;
+    }
+    return result;
+  }
 
-      GuiGLBuffer* ifsb = new GuiGLBuffer(ifs, materialColor);
-      shader->setVertexBuffer(ifsb);
-      if(vbo) { vbo->destroy(); delete vbo; }
+private:
+
+  float _plane[6][4];
+
+};
+
+//////////////////////////////////////////////////////////////////////
+// Appends the render items of a node and of its descendants to the
+// render list; model is the product of the matrices of the Transforms
+// above the node. Nodes other than Groups and Shapes are not drawn.
+void GuiGLWidget::_addRenderItems(Node* node, const QMatrix4x4& model) {
+
+  if(node==(Node*)0 || (node->isShape()==false && node->isGroup()==false))
+    return;
+
+  // the items are appended in depth-first order, and the index of the
+  // item which follows the subtree is set after visiting it
+  unsigned k = (unsigned)_renderList.size();
+  _renderList.push_back(RenderItem());
+  _renderList[k].node    = node;
+  _renderList[k].next    = k+1;
+  _renderList[k].parent  = (k>0)?_renderParent:0;
+  _renderList[k].nShapes = 0;
+  _renderList[k].faces   = (IndexedFaceSet*)0;
+  _renderList[k].shader  = (GuiGLShader*)0;
+  _renderList[k].model   = model;
+
+  if(node->isShape()) {
+    Node* geometry = ((Shape*)node)->getGeometry();
+    if(geometry!=(Node*)0 && geometry->isIndexedFaceSet())
+      _renderList[k].faces = (IndexedFaceSet*)geometry;
+    if(geometry!=(Node*)0 &&
+       (geometry->isIndexedFaceSet() || geometry->isIndexedLineSet()))
+      _renderList[k].nShapes = 1;
+    getShapeBBox((Shape*)node,model,
+                 _renderList[k].bboxMin,_renderList[k].bboxMax);
+    _shapeItems.push_back(k);
+  } else {
+    Group*     group      = (Group*)node;
+    QMatrix4x4 groupModel = model;
+    if(node->isTransform()) {
+      Transform* transform = (Transform*)node;
+      float T[16] = {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+      };
+      transform->getMatrix(T);
+      groupModel *=
+        QMatrix4x4(T[ 0],T[ 1],T[ 2],T[ 3],
+                   T[ 4],T[ 5],T[ 6],T[ 7],
+                   T[ 8],T[ 9],T[10],T[11],
+                   T[12],T[13],T[14],T[15]);
     }
+    unsigned nChildren = group->getNumberOfChildren();
+    unsigned parent    = _renderParent;
+    _renderParent = k;
+    for(unsigned i=0;i<nChildren;i++)
+      _addRenderItems((*group)[i],groupModel);
+    _renderParent = parent;
+    _renderList[k].next = (unsigned)_renderList.size();
+    _updateGroupBBox(k);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+// Recomputes the bounding box and the number of Shapes of a Group
+// item from those of its children.
+void GuiGLWidget::_updateGroupBBox(const unsigned k) {
+  RenderItem& group = _renderList[k];
+  setEmptyBBox(group.bboxMin,group.bboxMax);
+  group.nShapes = 0;
+  for(unsigned c=k+1;c<group.next;c=_renderList[c].next) {
+    RenderItem& child = _renderList[c];
+    addBBox(group.bboxMin,group.bboxMax,child.bboxMin,child.bboxMax);
+    group.nShapes += child.nShapes;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+// Applies the changes recorded in the geometry of a Shape item to its
+// vertex buffer, rebuilding it if its layout has changed. Returns
+// false if the Shape has nothing to draw.
+bool GuiGLWidget::_updateShape(RenderItem& item) {
+  GuiGLShader* shader = item.shader;
+  if(shader==(GuiGLShader*)0) return false;
+  GuiGLBuffer* vbo = shader->getVertexBuffer();
+  if(vbo!=(GuiGLBuffer*)0 && vbo->isUploaded()==false) return false;
+  if(vbo!=(GuiGLBuffer*)0 && vbo->update()==false) {
+    delete shader;
+    item.shader = _createShader((Shape*)item.node);
   }
+  return item.shader!=(GuiGLShader*)0;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Updates the bounding box of a Shape item, and those of the Groups
+// above it, if the coordinates of the Shape have changed. Returns
+// true in that case.
+bool GuiGLWidget::_updateShapeBBox(unsigned k) {
+  RenderItem& item = _renderList[k];
+  if(item.faces==(IndexedFaceSet*)0 ||
+     item.faces->hasChanged(IndexedFaceSet::CHANGED_COORD)==false)
+    return false;
+  getShapeBBox((Shape*)item.node,item.model,item.bboxMin,item.bboxMax);
+  while(k>0) _updateGroupBBox(k = _renderList[k].parent);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+void GuiGLWidget::_clearRenderList() {
+  _finishPacking();
+  for(size_t i=0;i<_renderList.size();i++) {
+    delete _renderList[i].shader;
+    _renderList[i].shader = (GuiGLShader*)0;
+  }
+  _renderList.clear();
+  _renderParent = 0;
+  _shapeItems.clear();
+  _uploadPacked = 0;
+  _uploadDone   = 0;
+}
+
+//////////////////////////////////////////////////////////////////////
+void GuiGLWidget::setQtLogo() {
+  SceneGraph* wrl = new GuiQtLogo();
+  _data.setSceneGraph(wrl);
+  _mainWindow->updateState();
+}
+
+//////////////////////////////////////////////////////////////////////
+void GuiGLWidget::invertNormal() {
+  // the vertex buffers are updated by paintShape
+  SceneGraph* pWrl = _data.getSceneGraph();
+  if(pWrl==(SceneGraph*)0) return;
+  SceneGraphProcessor processor(*pWrl);
+  processor.normalInvert();
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -356,69 +665,58 @@ void GuiGLWidget::initializeGL() {
 }
 
 //////////////////////////////////////////////////////////////////////
-void GuiGLWidget::paintShape(QMatrix4x4& mvp, Shape* shape) {
-  if(shape==(Shape*)0 || shape->getShow()==false) return;
-  if(dynamic_cast<IndexedFaceSet*>(shape->getGeometry()) ||
-     dynamic_cast<IndexedLineSet*>(shape->getGeometry())) {
-    if(GuiGLShader* shader = _shaderMap[shape]) {
-      shader->setMVPMatrix(mvp);
-      shader->paint(*this);
-    }
-  }
+// Returns false if the Shape could not be drawn.
+bool GuiGLWidget::paintShape(QMatrix4x4& mvp, RenderItem& item) {
+  // apply the changes made to the geometry since the last frame
+  if(_updateShape(item)==false) return false;
+  item.shader->setMVPMatrix(mvp*item.model);
+  item.shader->paint(*this);
+  return true;
 }
 
 //////////////////////////////////////////////////////////////////////
-void GuiGLWidget::paintGroup(QMatrix4x4& mvp, Group* group) {
-  if(group==(Group*)0 || group->getShow()==false) return;
-  unsigned nChildren = group->getNumberOfChildren();
-  for(unsigned i=0;i<nChildren;i++) {
-    Node* node = (*group)[i];
-    if(Shape* s = dynamic_cast<Shape*>(node)) {
-      paintShape(mvp, s);
-    } else if(Transform* t = dynamic_cast<Transform*>(node)) {
-      paintTransform(mvp, t);
-    } else if(Group* g = dynamic_cast<Group*>(node)) {
-      paintGroup(mvp, g);
-    }
-  }
-}
-
-//////////////////////////////////////////////////////////////////////
-void GuiGLWidget::paintTransform(QMatrix4x4& mvp, Transform* transform) {
-  if(transform==(Transform*)0 || transform->getShow()==false) return;
-
-  float T[16] = {
-    1.0f, 0.0f, 0.0f, 0.0f,
-    0.0f, 1.0f, 0.0f, 0.0f,
-    0.0f, 0.0f, 1.0f, 0.0f,
-    0.0f, 0.0f, 0.0f, 1.0f
-  };
-
-  transform->getMatrix(T);
-
-  // mvpt = mvp * T
-  QMatrix4x4 mvpt =
-    mvp *
-    QMatrix4x4(T[ 0],T[ 1],T[ 2],T[ 3],
-               T[ 4],T[ 5],T[ 6],T[ 7],
-               T[ 8],T[ 9],T[10],T[11],
-               T[12],T[13],T[14],T[15]);
+// Draws the render list, skipping the subtrees of the hidden nodes,
+// and, if culling is enabled, those whose bounding boxes are outside
+// of the view volume. The Shapes within a Group which is entirely
+// inside are not tested.
+void GuiGLWidget::paintData(QMatrix4x4& mvp) {
 
-  paintGroup(mvpt, transform);
-}
+  // the coordinates changed since the last frame may have moved Shapes
+  // in or out of view, even if they are not drawn now; the Shapes
+  // being packed are skipped, their boxes having been updated before
+  for(size_t s=0;s<_shapeItems.size();s++) {
+    if(_packThread.joinable() &&
+       s>=_uploadPacked && s<_uploadPacked+_packed.size()) continue;
+    unsigned k = _shapeItems[s];
+    if(_updateShapeBBox(k)) _updateShape(_renderList[k]);
+  }
 
-//////////////////////////////////////////////////////////////////////
-void GuiGLWidget::paintSceneGraph(QMatrix4x4& mvp, SceneGraph* wrl) {
-  if(wrl==(SceneGraph*)0 || wrl->getShow()==false) return;
-  paintGroup(mvp,wrl);
+  Frustum  frustum(mvp);
+  unsigned insideEnd = 0; // the items before are inside the frustum
+  _nShapesDrawn  = 0;
+  _nShapesCulled = 0;
+  const unsigned n = (unsigned)_renderList.size();
+  for(unsigned i=0;i<n;) {
+    RenderItem& item = _renderList[i];
+    if(item.node->getShow()==false) {
+      i = item.next;
+      continue;
+    }
+    if(_frustumCulling && i>=insideEnd) {
+      int test = frustum.test(item.bboxMin,item.bboxMax);
+      if(test==Frustum::OUTSIDE) {
+        _nShapesCulled += item.nShapes;
+        i = item.next;
+        continue;
+      }
+      if(test==Frustum::INSIDE) insideEnd = item.next;
+    }
+    if(item.shader!=(GuiGLShader*)0 && paintShape(mvp,item))
+      _nShapesDrawn++;
+    i++;
+  }
 }
 
-//////////////////////////////////////////////////////////////////////
-void GuiGLWidget::paintData(QMatrix4x4& mvp) {
-  SceneGraph* wrl = _data.getSceneGraph();
-  if(wrl!=(SceneGraph*)0) paintSceneGraph(mvp,wrl);
-}
-
 //////////////////////////////////////////////////////////////////////
 void GuiGLWidget::paintGL() {
 
@@ -467,7 +765,15 @@ void GuiGLWidget::paintGL() {
   mvp *= _viewRotation;
   mvp.translate(-_center.x(),-_center.y(),-_center.z());
 
+  // build and upload some more of the vertex buffers of a new scene
+  // graph; the shapes without a complete buffer are not drawn yet
+  _upload();
+
+  unsigned nDrawn  = _nShapesDrawn;
+  unsigned nCulled = _nShapesCulled;
   paintData(mvp);
+  if(_nShapesDrawn!=nDrawn || _nShapesCulled!=nCulled)
+    _mainWindow->updateRenderStatistics(_nShapesDrawn,_nShapesCulled);
 
   glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
   glDisable(GL_DEPTH_TEST);
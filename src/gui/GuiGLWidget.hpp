@@ -46,6 +46,10 @@
 #include <QMouseEvent>
 #include <QDragMoveEvent>
 
+#include <thread>
+#include <atomic>
+#include <map>
+
 #include "util/BBox.hpp"
 #include "wrl/SceneGraph.hpp"
 #include "wrl/Transform.hpp"
@@ -80,7 +84,27 @@ public:
 
   void resizeGL(int w, int h) Q_DECL_OVERRIDE;
 
-  void invertNormal(); // TODO
+  void invertNormal();
+
+  // The vertex buffers of a new scene graph are packed by a worker
+  // thread, and uploaded by paintGL, which spends about this many
+  // milliseconds per frame, so that the shapes appear progressively
+  // while the viewer remains responsive.
+  void setUploadBudget(const int msec) { _uploadBudget = (msec<1)?1:msec; }
+  int  getUploadBudget() const         { return            _uploadBudget; }
+  bool isUploading() const
+  { return _uploadDone<_shapeItems.size(); }
+
+  // Shapes whose world space bounding boxes are outside of the view
+  // volume are not drawn, unless culling is disabled; the numbers of
+  // Shapes drawn and culled by the last frame are kept, and shown by
+  // the GuiToolsWidget. Hidden Shapes are not counted as drawn, but
+  // those within a culled Group are counted as culled, since the
+  // subtree is not visited.
+  void setFrustumCulling(const bool value) { _frustumCulling = value; }
+  bool getFrustumCulling() const       { return        _frustumCulling; }
+  unsigned getNumberOfShapesDrawn() const  { return _nShapesDrawn;    }
+  unsigned getNumberOfShapesCulled() const { return _nShapesCulled;   }
 
   GuiViewerData& getData() const;
 
@@ -100,10 +124,6 @@ protected:
   // virtual void resizeEvent(QResizeEvent * event) Q_DECL_OVERRIDE;
 
   void paintData(QMatrix4x4& mvp);
-  void paintGroup(QMatrix4x4& mvp, Group* group);
-  void paintTransform(QMatrix4x4& mvp, Transform* transform);
-  void paintSceneGraph(QMatrix4x4& mvp, SceneGraph* wrl);
-  void paintShape(QMatrix4x4& mvp, Shape* shape);
 
   virtual void	enterEvent(QEnterEvent * event)                 Q_DECL_OVERRIDE;
   virtual void	leaveEvent(QEvent * event)                 Q_DECL_OVERRIDE;
@@ -114,9 +134,46 @@ protected:
 
 private:
 
+  // The scene graph flattened by setSceneGraph: the Groups and Shapes
+  // in depth-first order, so that paintGL draws it with a single loop.
+  // A hidden node is skipped along with its descendants by jumping to
+  // the item at next. The matrices of the Transforms are multiplied
+  // once, so changes to the Transform fields, as well as structural
+  // changes, must be followed by a call to setSceneGraph, which keeps
+  // the vertex buffers of the IndexedFaceSets still in the scene.
+  // Showing or hiding nodes only requires a new frame.
+  // The items also keep the world space bounding boxes of their
+  // subtrees, which are updated when coordinates change.
+  class RenderItem {
+  public:
+    Node*           node;
+    unsigned        next;    // item following the subtree of node
+    unsigned        parent;  // item of the parent Group
+    unsigned        nShapes; // Shapes with a drawable geometry in subtree
+    IndexedFaceSet* faces;   // geometry of Shapes, if an IndexedFaceSet
+    GuiGLShader*    shader;  // Shapes only; null until the buffer is built
+    QMatrix4x4      model;   // product of the Transform matrices above
+    float           bboxMin[3];
+    float           bboxMax[3];
+  };
+
+  bool paintShape(QMatrix4x4& mvp, RenderItem& item);
+
+  void _addRenderItems(Node* node, const QMatrix4x4& model);
+  void _updateGroupBBox(const unsigned k);
+  bool _updateShape(RenderItem& item);
+  bool _updateShapeBBox(unsigned k);
+  void _clearRenderList();
+  void _reuseShaders(map<Node*,RenderItem>& kept);
+
   void _setHomeView(const bool identity);
   void _setProjectionMatrix();
   void _zoom(const float value);
+
+  GuiGLShader* _createShader(Shape* shape, GuiGLBuffer* vbo=(GuiGLBuffer*)0);
+  void         _upload();
+  void         _startPacking();
+  void         _finishPacking();
 
 private:
 
@@ -145,7 +202,25 @@ private:
   bool                  _animationOn;
   qreal                 _fAngle;
 
-  map<Shape*,GuiGLShader*> _shaderMap;
+  vector<RenderItem>    _renderList;
+  unsigned              _renderParent; // while building _renderList
+
+  // render items of the Shapes, in order; the vertex buffers of those
+  // in [0,_uploadPacked) have been built, and those before _uploadDone
+  // have also been uploaded. While _packThread runs, it packs the
+  // buffers of the next _packed.size() Shapes, and reads their
+  // geometry, so the scene graph is not handed out until it is done.
+  vector<unsigned>      _shapeItems;
+  size_t                _uploadPacked;
+  size_t                _uploadDone;
+  int                   _uploadBudget;
+  thread                _packThread;
+  atomic<bool>          _packDone;
+  vector<GuiGLBuffer*>  _packed;
+
+  bool                  _frustumCulling;
+  unsigned              _nShapesDrawn;
+  unsigned              _nShapesCulled;
 
   GuiGLHandles*         _handles;
 
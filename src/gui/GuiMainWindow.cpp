@@ -44,12 +44,16 @@
 #include <QGroupBox>
 #include <QStatusBar>
 #include <QFileDialog>
+#include <QProgressDialog>
 #include <QRect>
 #include <QMargins>
 
 #include "io/LoaderWrl.hpp"
 #include "io/SaverWrl.hpp"
 
+#include "io/LoaderWrb.hpp"
+#include "io/SaverWrb.hpp"
+
 #include "io/LoaderStl.hpp"
 #include "io/SaverStl.hpp"
 
@@ -59,7 +63,12 @@ QString GuiMainWindow::_platformName  = "unknown";
 
 //////////////////////////////////////////////////////////////////////
 GuiMainWindow::GuiMainWindow(QWidget* parent):
-  QMainWindow(parent) {
+  QMainWindow(parent),
+  _loadDone(false),
+  _loadSuccess(false),
+  _loadWrl((SceneGraph*)0),
+  _loadFilename(""),
+  _loadDialog((QProgressDialog*)0) {
   setupUi(this);
   setWindowIcon(QIcon("qt.icns"));
   setWindowTitle(QString("DGP2026-A1 | Student : %1").arg(STUDENT_NAME));
@@ -69,7 +78,13 @@ GuiMainWindow::GuiMainWindow(QWidget* parent):
   SaverWrl* wrlSaver = new SaverWrl();
   _saver.registerSaver(wrlSaver);
 
+  LoaderWrb* wrbLoader = new LoaderWrb();
+  _loader.registerLoader(wrbLoader);
+  SaverWrb* wrbSaver = new SaverWrb();
+  _saver.registerSaver(wrbSaver);
+
   LoaderStl* stlLoader = new LoaderStl();
+  stlLoader->setWeldVertices(true);
   _loader.registerLoader(stlLoader);
   SaverStl* stlSaver = new SaverStl();
   _saver.registerSaver(stlSaver);
@@ -79,6 +94,12 @@ GuiMainWindow::GuiMainWindow(QWidget* parent):
   _timer->setInterval(_timerInterval);
   connect(_timer, SIGNAL(timeout()), glWidget, SLOT(update()));
 
+  // to follow the progress of background loads
+  _loader.setProgress(&_loadProgress);
+  _loadTimer = new QTimer(this);
+  _loadTimer->setInterval(50);
+  connect(_loadTimer, SIGNAL(timeout()), this, SLOT(loadSceneGraphPoll()));
+
   int tHeight = (_lDPI<=96)?600:(_lDPI<=144)?900:1200;
   int tWidth = (_lDPI<=96)?400:(_lDPI<=144)?600:800;
   int gHeight = tHeight;
@@ -104,6 +125,11 @@ GuiMainWindow::GuiMainWindow(QWidget* parent):
 
 //////////////////////////////////////////////////////////////////////
 GuiMainWindow::~GuiMainWindow() {
+  if(_loadThread.joinable()) {
+    _loadProgress.cancel();
+    _loadThread.join();
+    delete _loadWrl;
+  }
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -114,6 +140,10 @@ void GuiMainWindow::showStatusBarMessage(const QString & message) {
 //////////////////////////////////////////////////////////////////////
 SceneGraph* GuiMainWindow::loadSceneGraph(const char* fname) {
   static char str[1024];
+  if(isLoading()) {
+    showStatusBarMessage("another file is being loaded");
+    return (SceneGraph*)0;
+  }
   snprintf(str,1024,"Trying to load \"%s\" ...",fname);
   showStatusBarMessage(QString(str));
   SceneGraph* pWrl = new SceneGraph();
@@ -131,6 +161,85 @@ SceneGraph* GuiMainWindow::loadSceneGraph(const char* fname) {
   return pWrl;
 }
 
+//////////////////////////////////////////////////////////////////////
+bool GuiMainWindow::loadSceneGraphInBackground(const char* fname) {
+  if(isLoading()) {
+    showStatusBarMessage("another file is being loaded");
+    return false;
+  }
+
+  _loadFilename = fname;
+  _loadWrl      = new SceneGraph();
+  _loadSuccess  = false;
+  _loadDone     = false;
+  _loadProgress.reset();
+
+  // the progress is shown in permille of the file size
+  _loadDialog = new QProgressDialog
+    (QString("Loading \"%1\" ...").arg(fname),"Cancel",0,1000,this);
+  _loadDialog->setWindowModality(Qt::NonModal);
+  _loadDialog->setMinimumDuration(500);
+  _loadDialog->setAutoClose(false);
+  _loadDialog->setAutoReset(false);
+  _loadDialog->setValue(0);
+  connect(_loadDialog, SIGNAL(canceled()), this, SLOT(loadSceneGraphCancel()));
+  fileLoadAction->setEnabled(false);
+  showStatusBarMessage(QString("Loading \"%1\" ...").arg(fname));
+
+  // the worker thread only touches the new SceneGraph, so the viewer
+  // keeps drawing the current one until the load completes
+  _loadThread = thread([this]() {
+      _loadSuccess = _loader.load(_loadFilename.c_str(),*_loadWrl);
+      if(_loadSuccess) _loadWrl->updateBBox();
+      _loadDone = true;
+    });
+  _loadTimer->start();
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+void GuiMainWindow::loadSceneGraphCancel() {
+  _loadProgress.cancel();
+  showStatusBarMessage(QString("Canceling the load of \"%1\" ...")
+                       .arg(_loadFilename.c_str()));
+}
+
+//////////////////////////////////////////////////////////////////////
+void GuiMainWindow::loadSceneGraphPoll() {
+  if(isLoading()==false) { _loadTimer->stop(); return; }
+
+  size_t done  = _loadProgress.getDone();
+  size_t total = _loadProgress.getTotal();
+  if(total>0 && _loadProgress.isCanceled()==false)
+    _loadDialog->setValue((done<total)?(int)((1000.0*done)/total):999);
+  if(_loadDone==false) return;
+
+  _loadThread.join();
+  _loadTimer->stop();
+  _loadDialog->hide();
+  _loadDialog->deleteLater();
+  _loadDialog = (QProgressDialog*)0;
+  fileLoadAction->setEnabled(true);
+
+  // the new SceneGraph replaces the current one, which is deleted, and
+  // the GPU buffers are created for it, all in the GUI thread
+  static char str[1024];
+  SceneGraph* pWrl = _loadWrl;
+  _loadWrl = (SceneGraph*)0;
+  if(_loadSuccess) {
+    snprintf(str,1024,"Loaded \"%s\"",_loadFilename.c_str());
+    glWidget->setSceneGraph(pWrl,true);
+    toolsWidget->updateState();
+  } else {
+    if(_loadProgress.isCanceled())
+      snprintf(str,1024,"Canceled the load of \"%s\"",_loadFilename.c_str());
+    else
+      snprintf(str,1024,"Unable to load \"%s\"",_loadFilename.c_str());
+    delete pWrl;
+  }
+  showStatusBarMessage(QString(str));
+}
+
 //////////////////////////////////////////////////////////////////////
 void GuiMainWindow::on_fileLoadAction_triggered() {
 
@@ -142,7 +251,7 @@ void GuiMainWindow::on_fileLoadAction_triggered() {
   QFileDialog fileDialog(this);
   fileDialog.setFileMode(QFileDialog::ExistingFile); // allowed to select only one 
   fileDialog.setAcceptMode(QFileDialog::AcceptOpen);
-  fileDialog.setNameFilter(tr("3D Files (*.wrl *.stl)"));
+  fileDialog.setNameFilter(tr("3D Files (*.wrl *.wrb *.stl)"));
   QStringList fileNames;
   if(fileDialog.exec()) {
     fileNames = fileDialog.selectedFiles();
@@ -153,7 +262,7 @@ void GuiMainWindow::on_fileLoadAction_triggered() {
   if (filename.empty()) {
     showStatusBarMessage("load filename is empty");
   } else {
-    loadSceneGraph(filename.c_str());
+    loadSceneGraphInBackground(filename.c_str());
   } 
 
   // restart animation
@@ -175,7 +284,7 @@ void GuiMainWindow::on_fileSaveAction_triggered() {
   // TODO Sat Sep 10 22:18:57 2016
   // get list of file extensions from registered Savers
 
-  fileDialog.setNameFilter(tr("3D Files (*.wrl *.stl)"));
+  fileDialog.setNameFilter(tr("3D Files (*.wrl *.wrb *.stl)"));
   QStringList fileNames;
   if(fileDialog.exec()) {
     fileNames = fileDialog.selectedFiles();
@@ -263,3 +372,24 @@ void GuiMainWindow::updateState() {
 void GuiMainWindow::refresh() {
   glWidget->update();
 }
+
+bool GuiMainWindow::getFrustumCulling() {
+  return glWidget->getFrustumCulling();
+}
+
+void GuiMainWindow::setFrustumCulling(const bool value) {
+  glWidget->setFrustumCulling(value);
+  glWidget->update();
+}
+
+int GuiMainWindow::getUploadBudget() {
+  return glWidget->getUploadBudget();
+}
+
+void GuiMainWindow::setUploadBudget(const int msec) {
+  glWidget->setUploadBudget(msec);
+}
+
+void GuiMainWindow::updateRenderStatistics(unsigned nDrawn, unsigned nCulled) {
+  toolsWidget->updateRenderStatistics(nDrawn,nCulled);
+}
@@ -36,6 +36,8 @@
 #define _GUI_MAIN_WINDOW_HPP_
 
 #include <string>
+#include <thread>
+#include <atomic>
 
 #include <QMainWindow>
 #include "ui_GuiMainWindow.h"
@@ -48,6 +50,7 @@
 #include <string>
 
 QT_FORWARD_DECLARE_CLASS(QOpenGLWidget)
+QT_FORWARD_DECLARE_CLASS(QProgressDialog)
 
 class GuiMainWindow : public QMainWindow, public Ui::GuiMainWindow {
 
@@ -70,9 +73,24 @@ public:
   void           setSceneGraph(SceneGraph* pWrl, bool resetHomeView);
   SceneGraph*    loadSceneGraph(const char* fname);
 
+  // loads the file in a worker thread, showing the progress in a dialog
+  // from which the load can be canceled; when the load completes, the
+  // new SceneGraph replaces the current one; returns false if another
+  // load is still in progress
+  bool           loadSceneGraphInBackground(const char* fname);
+  bool           isLoading() const { return _loadThread.joinable(); }
+
   void updateState();
   void refresh();
 
+  // rendering options of the GuiGLWidget, and the statistics of the
+  // last frame, shown by the GuiToolsWidget
+  bool getFrustumCulling();
+  void setFrustumCulling(const bool value);
+  int  getUploadBudget();
+  void setUploadBudget(const int msec);
+  void updateRenderStatistics(unsigned nDrawn, unsigned nCulled);
+
   static void setLogicalDotsPerInch(int lDPI) {         _lDPI = lDPI; }
   static void setPlatformName(QString& name)  { _platformName = name; }
 
@@ -85,19 +103,32 @@ private slots:
   void on_toolsHideAction_triggered();
   void on_helpAboutAction_triggered();
 
+  void loadSceneGraphPoll();
+  void loadSceneGraphCancel();
+
 protected:
 
   virtual void resizeEvent(QResizeEvent * event) Q_DECL_OVERRIDE;
 
 private:
 
-  AppLoader       _loader;
-  AppSaver        _saver;
-  QTimer         *_timer;
-
-  static int      _timerInterval;
-  static int      _lDPI;
-  static QString  _platformName;
+  AppLoader        _loader;
+  AppSaver         _saver;
+  QTimer          *_timer;
+
+  // background load
+  thread           _loadThread;
+  LoaderProgress   _loadProgress;
+  atomic<bool>     _loadDone;
+  bool             _loadSuccess;
+  SceneGraph*      _loadWrl;
+  string           _loadFilename;
+  QProgressDialog *_loadDialog;
+  QTimer          *_loadTimer;
+
+  static int       _timerInterval;
+  static int       _lDPI;
+  static QString   _platformName;
 };
 
 #endif // _GUI_MAIN_WINDOW_HPP_
@@ -47,6 +47,7 @@ GuiToolsWidget::GuiToolsWidget(QWidget* parent):
   _mainWindow() {
   (void) parent;
   setupUi(this);
+  updateRenderStatistics(0,0);
   const QObjectList & list = this->children();
   for(int i=0; i<list.size(); ++i) {
     QObject* obj = list.at(i);
@@ -83,6 +84,8 @@ void GuiToolsWidget::updateState() {
     ("  "+QString::number(_mainWindow->getGLWidgetWidth()));
   edit3DCanvasHeight->setText
     ("  "+QString::number(_mainWindow->getGLWidgetHeight()));
+  checkBox3DCanvasCulling->setChecked(_mainWindow->getFrustumCulling());
+  spinBox3DCanvasUploadBudget->setValue(_mainWindow->getUploadBudget());
 
   GuiViewerData& data  = _mainWindow->getData();
 
@@ -109,6 +112,7 @@ void GuiToolsWidget::updateState() {
 
     pushButtonSceneGraphNormalNone->setEnabled(false);
     pushButtonSceneGraphNormalPerVertex->setEnabled(false);
+    comboBoxSceneGraphNormalWeight->setEnabled(false);
     pushButtonSceneGraphNormalPerFace->setEnabled(false);
     pushButtonSceneGraphNormalPerCorner->setEnabled(false);
     pushButtonSceneGraphNormalInvert->setEnabled(false);
@@ -146,6 +150,7 @@ void GuiToolsWidget::updateState() {
     value = processor.hasIndexedFaceSetNormalPerVertex();
     hasNormal |= value;
     pushButtonSceneGraphNormalPerVertex->setEnabled(hasFaces && !value);
+    comboBoxSceneGraphNormalWeight->setEnabled(hasFaces);
     value = processor.hasIndexedFaceSetNormalPerFace();
     hasNormal |= value;
     pushButtonSceneGraphNormalPerFace->setEnabled(hasFaces && !value);
@@ -343,6 +348,20 @@ void GuiToolsWidget::on_editBBoxScale_returnPressed() {
   }
 }
 
+// numbers of Shapes drawn and culled by the last frame
+void GuiToolsWidget::updateRenderStatistics(unsigned nDrawn, unsigned nCulled) {
+  edit3DCanvasDrawn->setText("  "+QString::number(nDrawn));
+  edit3DCanvasCulled->setText("  "+QString::number(nCulled));
+}
+
+void GuiToolsWidget::on_checkBox3DCanvasCulling_stateChanged(int state) {
+  _mainWindow->setFrustumCulling(state!=0);
+}
+
+void GuiToolsWidget::on_spinBox3DCanvasUploadBudget_valueChanged(int msec) {
+  _mainWindow->setUploadBudget(msec);
+}
+
 void GuiToolsWidget::on_checkBoxBBoxCube_stateChanged(int state) {
   GuiViewerData& data = _mainWindow->getData();
   data.setBBoxCube((state!=0));
@@ -393,7 +412,6 @@ void GuiToolsWidget::on_pushButtonSceneGraphEdgesShow_clicked() {
   Node* node = pWrl->find("EDGES");
   if(node==(Node*)0) return;
   node->setShow(true);
-  _mainWindow->setSceneGraph(pWrl,false);
   _mainWindow->refresh();
   updateState();
 }
@@ -405,7 +423,6 @@ void GuiToolsWidget::on_pushButtonSceneGraphEdgesHide_clicked() {
   Node* node = pWrl->find("EDGES");
   if(node==(Node*)0) return;
   node->setShow(false);
-  _mainWindow->setSceneGraph(pWrl,false);
   _mainWindow->refresh();
   updateState();
 }
@@ -416,7 +433,6 @@ void GuiToolsWidget::on_pushButtonSceneGraphNormalInvert_clicked() {
   if(pWrl!=(SceneGraph*)0) {
     SceneGraphProcessor processor(*pWrl);
     processor.normalInvert();
-    _mainWindow->setSceneGraph(pWrl,false);
     _mainWindow->refresh();
     updateState();
   }
@@ -428,7 +444,6 @@ void GuiToolsWidget::on_pushButtonSceneGraphNormalNone_clicked() {
   if(pWrl!=(SceneGraph*)0) {
     SceneGraphProcessor processor(*pWrl);
     processor.normalClear();
-    _mainWindow->setSceneGraph(pWrl,false);
     _mainWindow->refresh();
     updateState();
   }
@@ -439,8 +454,25 @@ void GuiToolsWidget::on_pushButtonSceneGraphNormalPerVertex_clicked() {
   SceneGraph*    pWrl = data.getSceneGraph();
   if(pWrl!=(SceneGraph*)0) {
     SceneGraphProcessor processor(*pWrl);
-    processor.computeNormalPerVertex();
-    _mainWindow->setSceneGraph(pWrl,false);
+    int weight = comboBoxSceneGraphNormalWeight->currentIndex();
+    processor.computeNormalPerVertex
+      ((SceneGraphProcessor::NormalWeight)weight);
+    _mainWindow->refresh();
+    updateState();
+  }
+}
+
+// recompute the per-vertex normals, if present, with the new weighting;
+// the per-face and per-corner normals are left as they are
+void GuiToolsWidget::on_comboBoxSceneGraphNormalWeight_currentIndexChanged
+(int index) {
+  GuiViewerData& data = _mainWindow->getData();
+  SceneGraph*    pWrl = data.getSceneGraph();
+  if(pWrl!=(SceneGraph*)0) {
+    SceneGraphProcessor processor(*pWrl);
+    if(processor.hasIndexedFaceSetNormalPerVertex()==false) return;
+    processor.recomputeNormalPerVertex
+      ((SceneGraphProcessor::NormalWeight)index);
     _mainWindow->refresh();
     updateState();
   }
@@ -452,7 +484,6 @@ void GuiToolsWidget::on_pushButtonSceneGraphNormalPerFace_clicked() {
   if(pWrl!=(SceneGraph*)0) {
     SceneGraphProcessor processor(*pWrl);
     processor.computeNormalPerFace();
-    _mainWindow->setSceneGraph(pWrl,false);
     _mainWindow->refresh();
     updateState();
   }
@@ -464,7 +495,6 @@ void GuiToolsWidget::on_pushButtonSceneGraphNormalPerCorner_clicked() {
   if(pWrl!=(SceneGraph*)0) {
     SceneGraphProcessor processor(*pWrl);
     processor.computeNormalPerCorner();
-    _mainWindow->setSceneGraph(pWrl,false);
     _mainWindow->refresh();
     updateState();
   }
@@ -489,7 +519,6 @@ void GuiToolsWidget::on_pushButtonPointsShow_clicked() {
   Node* node = pWrl->find("POINTS");
   if(node==(Node*)0) return;
   node->setShow(true);
-  _mainWindow->setSceneGraph(pWrl,false);
   _mainWindow->refresh();
   updateState();
 }
@@ -501,7 +530,6 @@ void GuiToolsWidget::on_pushButtonPointsHide_clicked() {
   Node* node = pWrl->find("POINTS");
   if(node==(Node*)0) return;
   node->setShow(false);
-  _mainWindow->setSceneGraph(pWrl,false);
   _mainWindow->refresh();
   updateState();
 }
@@ -512,7 +540,6 @@ void GuiToolsWidget::on_pushButtonSceneGraphIndexedFaceSetsShow_clicked() {
   if(pWrl!=(SceneGraph*)0) {
     SceneGraphProcessor processor(*pWrl);
     processor.shapeIndexedFaceSetShow();
-    _mainWindow->setSceneGraph(pWrl,false);
     _mainWindow->refresh();
     updateState();
   }
@@ -524,7 +551,6 @@ void GuiToolsWidget::on_pushButtonSceneGraphIndexedFaceSetsHide_clicked() {
   if(pWrl!=(SceneGraph*)0) {
     SceneGraphProcessor processor(*pWrl);
     processor.shapeIndexedFaceSetHide();
-    _mainWindow->setSceneGraph(pWrl,false);
     _mainWindow->refresh();
     updateState();
   }
@@ -536,7 +562,6 @@ void GuiToolsWidget::on_pushButtonSceneGraphIndexedLineSetsShow_clicked() {
   if(pWrl!=(SceneGraph*)0) {
     SceneGraphProcessor processor(*pWrl);
     processor.shapeIndexedLineSetShow();
-    _mainWindow->setSceneGraph(pWrl,false);
     _mainWindow->refresh();
     updateState();
   }
@@ -548,7 +573,6 @@ void GuiToolsWidget::on_pushButtonSceneGraphIndexedLineSetsHide_clicked() {
   if(pWrl!=(SceneGraph*)0) {
     SceneGraphProcessor processor(*pWrl);
     processor.shapeIndexedLineSetHide();
-    _mainWindow->setSceneGraph(pWrl,false);
     _mainWindow->refresh();
     updateState();
   }
@@ -573,7 +597,6 @@ void GuiToolsWidget::on_pushButtonSurfaceShow_clicked() {
   Node* node = pWrl->find("SURFACE");
   if(node==(Node*)0) return;
   node->setShow(true);
-  _mainWindow->setSceneGraph(pWrl,false);
   _mainWindow->refresh();
   updateState();
 }
@@ -585,7 +608,6 @@ void GuiToolsWidget::on_pushButtonSurfaceHide_clicked() {
   Node* node = pWrl->find("SURFACE");
   if(node==(Node*)0) return;
   node->setShow(false);
-  _mainWindow->setSceneGraph(pWrl,false);
   _mainWindow->refresh();
   updateState();
 }
@@ -59,6 +59,7 @@ public slots:
                    
   void setMainWindow(GuiMainWindow *mw);
   void updateState();
+  void updateRenderStatistics(unsigned nDrawn, unsigned nCulled);
 
 #ifdef _WIN32
   static void setLocalDotsPerInch(const int lDPI) { _lDPI = lDPI; }
@@ -70,6 +71,10 @@ protected:
 
 private slots:
 
+  // 3D canvas
+  void on_checkBox3DCanvasCulling_stateChanged(int state);
+  void on_spinBox3DCanvasUploadBudget_valueChanged(int msec);
+
   // bounding box
   void bboxCube();
   void bboxDepthUp();
@@ -84,6 +89,7 @@ private slots:
   // scene graph
   void on_pushButtonSceneGraphNormalNone_clicked();
   void on_pushButtonSceneGraphNormalPerVertex_clicked();
+  void on_comboBoxSceneGraphNormalWeight_currentIndexChanged(int index);
   void on_pushButtonSceneGraphNormalInvert_clicked();
   void on_pushButtonSceneGraphNormalPerFace_clicked();
   void on_pushButtonSceneGraphNormalPerCorner_clicked();
@@ -32,10 +32,210 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
 #include "AppLoader.hpp"
+#include "FileMap.hpp"
 
+//////////////////////////////////////////////////////////////////////
+// parse cache helpers
+
+static bool fileStat(const char* filename, uint64_t& size, int64_t& mtime) {
+  struct stat st;
+  if(stat(filename,&st)!=0) return false;
+  size  = (uint64_t)st.st_size;
+  // nanoseconds, where available
+#if defined(__APPLE__)
+  mtime = (int64_t)st.st_mtimespec.tv_sec*1000000000+st.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+  mtime = (int64_t)st.st_mtime*1000000000;
+#else
+  mtime = (int64_t)st.st_mtim.tv_sec*1000000000+st.st_mtim.tv_nsec;
+#endif
+  return true;
+}
+
+static string absolutePath(const char* filename) {
+#ifdef _WIN32
+  char* path = _fullpath((char*)0,filename,0);
+#else
+  char* path = realpath(filename,(char*)0);
+#endif
+  string str((path!=(char*)0)?path:filename);
+  free(path);
+  return str;
+}
+
+static bool makeDirectory(const string& dir) {
+  struct stat st;
+  if(stat(dir.c_str(),&st)==0) return (st.st_mode&S_IFDIR)!=0;
+#ifdef _WIN32
+  return _mkdir(dir.c_str())==0;
+#else
+  return mkdir(dir.c_str(),0755)==0;
+#endif
+}
+
+// 64 bit FNV-1a, applied to 8 byte words rather than to single bytes,
+// so that hashing runs close to memory speed
+static uint64_t hashBytes(const char* data, const size_t size) {
+  const uint64_t prime = 0x100000001b3ULL;
+  uint64_t h = 0xcbf29ce484222325ULL ^ (uint64_t)size;
+  size_t i = 0;
+  for(;i+8<=size;i+=8) {
+    uint64_t w;
+    memcpy(&w,data+i,8);
+    h = (h^w)*prime;
+  }
+  for(;i<size;i++)
+    h = (h^(uint64_t)(unsigned char)data[i])*prime;
+  return h;
+}
+
+static bool hashFile(const char* filename, uint64_t& hash) {
+  FileMap file;
+  if(file.open(filename)==false) return false;
+  hash = hashBytes(file.getData(),file.getSize());
+  return true;
+}
+
+// the key file contains one line with the size, modification time and
+// content hash of the source file, a second line with its path, and a
+// third one with the url set by its loader
+class CacheKey {
+public:
+  string   path;
+  string   url;
+  uint64_t size;
+  int64_t  mtime;
+  uint64_t hash;
+public:
+  CacheKey():path(""),url(""),size(0),mtime(0),hash(0) {}
+
+  bool read(const string& filename) {
+    FILE* fp = fopen(filename.c_str(),"r");
+    if(fp==(FILE*)0) return false;
+    unsigned long long s,h;
+    long long t;
+    char line[4096];
+    char urlLine[4096];
+    bool success =
+      fscanf(fp,"%llu %lld %llx\n",&s,&t,&h)==3 &&
+      fgets(line,sizeof(line),fp)!=(char*)0 &&
+      fgets(urlLine,sizeof(urlLine),fp)!=(char*)0;
+    fclose(fp);
+    if(success) {
+      size_t n = strlen(line);
+      if(n>0 && line[n-1]=='\n') line[--n] = '\0';
+      n = strlen(urlLine);
+      if(n>0 && urlLine[n-1]=='\n') urlLine[--n] = '\0';
+      path  = line;
+      url   = urlLine;
+      size  = (uint64_t)s;
+      mtime = (int64_t)t;
+      hash  = (uint64_t)h;
+    }
+    return success;
+  }
+
+  bool write(const string& filename) const {
+    FILE* fp = fopen(filename.c_str(),"w");
+    if(fp==(FILE*)0) return false;
+    // a file modified within the last couple of seconds may be
+    // modified again without changing its time stamp, on file systems
+    // with a coarse clock; in that case the time is not recorded, to
+    // force a content hash check on the next load
+    int64_t t = mtime;
+    if(t/1000000000>=(int64_t)time((time_t*)0)-2) t = 0;
+    bool success =
+      fprintf(fp,"%llu %lld %016llx\n%s\n%s\n",
+              (unsigned long long)size,(long long)t,
+              (unsigned long long)hash,path.c_str(),url.c_str())>0;
+    if(fclose(fp)!=0) success = false;
+    return success;
+  }
+};
+
+//////////////////////////////////////////////////////////////////////
+void AppLoader::setCacheDirectory(const string& dir) {
+  _cacheDirectory = dir;
+}
+
+//////////////////////////////////////////////////////////////////////
+bool AppLoader::loadCached
+(const char* filename, Loader* loader, SceneGraph& wrl) {
+
+  uint64_t size;
+  int64_t  mtime;
+  if(fileStat(filename,size,mtime)==false)
+    return loader->load(filename,wrl);
+
+  // the cache files are named after the hash of the absolute path
+  string path = absolutePath(filename);
+  char name[32];
+  snprintf(name,sizeof(name),"/%016llx",
+           (unsigned long long)hashBytes(path.data(),path.size()));
+  string keyFile = _cacheDirectory+name+".key";
+  string wrbFile = _cacheDirectory+name+".wrb";
+
+  // the file content is only hashed if the size matches, but the
+  // modification time does not
+  CacheKey key;
+  uint64_t hash     = 0;
+  bool     haveHash = false;
+  bool     hit      = key.read(keyFile) && key.path==path && key.size==size;
+  if(hit && key.mtime!=mtime) {
+    haveHash = hashFile(filename,hash);
+    hit      = haveHash && key.hash==hash;
+  }
+
+  // the url is restored as set by the loader, which may differ from
+  // the filename (e.g. LoaderStl leaves it empty)
+  if(hit && _cacheLoader.load(wrbFile.c_str(),wrl)) {
+    wrl.setUrl(key.url);
+    if(key.mtime!=mtime) {
+      key.mtime = mtime;
+      key.write(keyFile);
+    }
+    _loadedFromCache = true;
+    return true;
+  }
+
+  // cache miss: parse the file, and save a new snapshot
+  if(loader->load(filename,wrl)==false) return false;
+  if(haveHash==false) haveHash = hashFile(filename,hash);
+  if(haveHash && makeDirectory(_cacheDirectory)) {
+    // the old key is removed first, and the new one is written last,
+    // so that a key file never refers to a different snapshot
+    string tmpFile = wrbFile+".tmp";
+    remove(keyFile.c_str());
+    remove(wrbFile.c_str());
+    if(_cacheSaver.save(tmpFile.c_str(),wrl) &&
+       rename(tmpFile.c_str(),wrbFile.c_str())==0) {
+      key.path  = path;
+      key.url   = wrl.getUrl();
+      key.size  = size;
+      key.mtime = mtime;
+      key.hash  = hash;
+      key.write(keyFile);
+    } else {
+      remove(tmpFile.c_str());
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////
 bool AppLoader::load(const char* filename, SceneGraph& wrl) {
   bool success = false;
+  _loadedFromCache = false;
   if(filename!=(const char*)0) {
     // int n = (int)strlen(filename);
     string f(filename);
@@ -47,15 +247,29 @@ bool AppLoader::load(const char* filename, SceneGraph& wrl) {
     if(i>=0) {
       string ext(filename+i+1);
       Loader* loader = _registry[ext];
-      if(loader!=(Loader*)0)
-        success = loader->load(filename,wrl);
+      if(loader!=(Loader*)0) {
+        // .wrb files are snapshots already
+        if(_cacheDirectory!="" && ext!=_cacheLoader.ext())
+          success = loadCached(filename,loader,wrl);
+        else
+          success = loader->load(filename,wrl);
+      }
     }
   }
   return success;
 }
 
+void AppLoader::setProgress(LoaderProgress* progress) {
+  _progress = progress;
+  map<string,Loader*>::iterator i;
+  for(i=_registry.begin();i!=_registry.end();i++)
+    if(i->second!=(Loader*)0) i->second->setProgress(progress);
+  _cacheLoader.setProgress(progress);
+}
+
 void AppLoader::registerLoader(Loader* loader) {
   if(loader!=(Loader*)0) {
+    loader->setProgress(_progress);
     string ext(loader->ext()); // constructed from const char*
     pair<string,Loader*> ext_loader(ext,loader);
     _registry.insert(ext_loader);
@@ -38,22 +38,56 @@
 #include <map>
 #include <string>
 #include "LoaderWrl.hpp"
+#include "LoaderWrb.hpp"
+#include "SaverWrb.hpp"
 
 using namespace std;
 
+// Optional parse cache: when a cache directory is set, every file
+// successfully loaded by one of the registered loaders is also saved
+// as a .wrb snapshot in the cache directory, together with a small
+// key file recording the absolute path, size, modification time and
+// content hash of the source file, and the url set by its loader.
+// Later loads of the same path read the snapshot instead of parsing
+// the file, as long as the size and modification time are unchanged;
+// if only the modification time has changed, the content hash
+// decides. The snapshot records the result of the loader, so the
+// cache directory should not be shared between runs which configure
+// the loaders differently (e.g. STL welding).
+
 class AppLoader {
 
 public:
 
-  AppLoader() {}
+  AppLoader():
+    _cacheDirectory(""),_loadedFromCache(false),
+    _progress((LoaderProgress*)0) {}
   ~AppLoader() {}
 
   bool load(const char* filename, SceneGraph& wrl);
   void registerLoader(Loader* loader);
 
+  // progress reported by the registered loaders, including those
+  // registered later, and by the cache loader; null disables reports
+  void setProgress(LoaderProgress* progress);
+
+  // an empty directory name, the default, disables the cache
+  void          setCacheDirectory(const string& dir);
+  const string& getCacheDirectory() const { return _cacheDirectory; }
+
+  // true if the last successful load read a cached snapshot
+  bool          loadedFromCache() const { return _loadedFromCache; }
+
 private:
 
+  bool loadCached(const char* filename, Loader* loader, SceneGraph& wrl);
+
   map<string, Loader*> _registry;
+  string               _cacheDirectory;
+  bool                 _loadedFromCache;
+  LoaderProgress*      _progress;
+  LoaderWrb            _cacheLoader;
+  SaverWrb             _cacheSaver;
 
 };
 
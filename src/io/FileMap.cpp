@@ -0,0 +1,128 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// FileMap.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "FileMap.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+FileMap::FileMap():
+  _open(false),
+  _data((const char*)0),
+  _size(0)
+#ifdef _WIN32
+  ,_file((void*)0)
+  ,_mapping((void*)0)
+#else
+  ,_fd(-1)
+#endif
+{
+}
+
+FileMap::~FileMap() {
+  close();
+}
+
+#ifdef _WIN32
+
+bool FileMap::open(const char* filename) {
+  close();
+  if(filename==(char*)0) return false;
+  HANDLE file = CreateFileA(filename,GENERIC_READ,FILE_SHARE_READ,NULL,
+                            OPEN_EXISTING,FILE_FLAG_SEQUENTIAL_SCAN,NULL);
+  if(file==INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER size;
+  if(GetFileSizeEx(file,&size)==0) { CloseHandle(file); return false; }
+  _file = (void*)file;
+  _size = (size_t)size.QuadPart;
+  if(_size>0) {
+    HANDLE mapping = CreateFileMappingA(file,NULL,PAGE_READONLY,0,0,NULL);
+    if(mapping==NULL) { close(); return false; }
+    _mapping = (void*)mapping;
+    _data = (const char*)MapViewOfFile(mapping,FILE_MAP_READ,0,0,0);
+    if(_data==(const char*)0) { close(); return false; }
+  }
+  _open = true;
+  return true;
+}
+
+void FileMap::close() {
+  if(_data!=(const char*)0) UnmapViewOfFile((LPCVOID)_data);
+  if(_mapping!=(void*)0)    CloseHandle((HANDLE)_mapping);
+  if(_file!=(void*)0)       CloseHandle((HANDLE)_file);
+  _open    = false;
+  _data    = (const char*)0;
+  _size    = 0;
+  _file    = (void*)0;
+  _mapping = (void*)0;
+}
+
+#else /* POSIX */
+
+bool FileMap::open(const char* filename) {
+  close();
+  if(filename==(char*)0) return false;
+  _fd = ::open(filename,O_RDONLY);
+  if(_fd<0) return false;
+  struct stat st;
+  if(fstat(_fd,&st)!=0 || !S_ISREG(st.st_mode)) { close(); return false; }
+  _size = (size_t)st.st_size;
+  if(_size>0) {
+    void* data = mmap((void*)0,_size,PROT_READ,MAP_PRIVATE,_fd,0);
+    if(data==MAP_FAILED) { close(); return false; }
+    _data = (const char*)data;
+#ifdef POSIX_MADV_SEQUENTIAL
+    posix_madvise(data,_size,POSIX_MADV_SEQUENTIAL);
+#endif
+  }
+  _open = true;
+  return true;
+}
+
+void FileMap::close() {
+  if(_data!=(const char*)0) munmap((void*)_data,_size);
+  if(_fd>=0)                ::close(_fd);
+  _open = false;
+  _data = (const char*)0;
+  _size = 0;
+  _fd   = -1;
+}
+
+#endif
@@ -0,0 +1,79 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// FileMap.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _FILE_MAP_HPP_
+#define _FILE_MAP_HPP_
+
+#include <stddef.h>
+
+// Read-only memory mapping of a whole file. The loaders use it to
+// parse the file contents in place, without copying the bytes through
+// stdio buffers. The mapped bytes are not NUL-terminated; always use
+// getSize() to bound the parsing.
+
+class FileMap {
+
+public:
+
+              FileMap();
+              ~FileMap();
+
+  // Returns false if the file cannot be opened or mapped. An empty
+  // file is mapped successfully, with getSize()==0.
+  bool        open(const char* filename);
+  void        close();
+
+  bool        isOpen()  const { return _open; }
+  const char* getData() const { return _data; }
+  size_t      getSize() const { return _size; }
+
+private:
+
+  // not copyable
+              FileMap(const FileMap&);
+  FileMap&    operator=(const FileMap&);
+
+  bool        _open;
+  const char* _data;
+  size_t      _size;
+#ifdef _WIN32
+  void*       _file;
+  void*       _mapping;
+#else
+  int         _fd;
+#endif
+
+};
+
+#endif /* _FILE_MAP_HPP_ */
@@ -35,15 +35,67 @@
 #ifndef _Loader_hpp_
 #define _Loader_hpp_
 
+#include <stddef.h>
+#include <atomic>
 #include <wrl/SceneGraph.hpp>
+#include "StrException.hpp"
+
+// Progress of a load, in bytes of the input file. The load may run in
+// a worker thread, while another thread reads the progress and
+// requests the cancellation of the load.
+
+class LoaderProgress {
+
+public:
+
+  LoaderProgress():_done(0),_total(0),_canceled(false) {}
+
+  void   reset()            { _done = 0; _total = 0; _canceled = false; }
+  void   cancel()           { _canceled = true; }
+  bool   isCanceled() const { return _canceled; }
+
+  void   set(const size_t done, const size_t total)
+  { _total = total; _done = done; }
+  size_t getDone()    const { return _done;  }
+  size_t getTotal()   const { return _total; }
+
+private:
+
+  atomic<size_t> _done;
+  atomic<size_t> _total;
+  atomic<bool>   _canceled;
+
+};
 
 class Loader {
 
 public:
 
+  Loader():_progress((LoaderProgress*)0) {}
+  virtual ~Loader() {}
+
   virtual bool  load(const char* filename, SceneGraph& wrl) = 0;
   virtual const char* ext() const = 0;
 
+  // progress reported by the following calls to load(), or none if
+  // progress==null
+  void  setProgress(LoaderProgress* progress) { _progress = progress; }
+  LoaderProgress* getProgress() const { return _progress; }
+
+protected:
+
+  // called by load() from time to time; throws a StrException, to be
+  // handled as any other load error, if the load has been canceled
+  void  progress(const size_t done, const size_t total) {
+    if(_progress==(LoaderProgress*)0) return;
+    _progress->set(done,total);
+    if(_progress->isCanceled()) throw new StrException("load canceled");
+  }
+
+private:
+
+  LoaderProgress* _progress;
+
 };
 
 #endif // _Loader_hpp_
@@ -35,7 +35,10 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <stdio.h>
-#include "TokenizerFile.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "FileMap.hpp"
 #include "LoaderStl.hpp"
 #include "StrException.hpp"
 
@@ -44,58 +47,178 @@
 #include "wrl/Material.hpp"
 #include "wrl/IndexedFaceSet.hpp"
 
+#include "core/VertexWeld.hpp"
+
 // reference
 // https://en.wikipedia.org/wiki/STL_(file_format)
 
 const char* LoaderStl::_ext = "stl";
 
-bool LoaderStl::loadFace(Tokenizer&tkn, std::vector<float>& normal, std::vector<float>& coord, std::vector<int>& coordIndex){
-	// double check
-	if(!tkn.equals("facet")) throw new StrException("Expected 'facet'");
-	
-	// normal vector part
-	if (tkn.expecting("normal")){
-		float norm_coordinate;
-		int norm_coord_num = 0;
-		while(norm_coord_num < 3){
-			if (!tkn.getFloat(norm_coordinate)) throw new StrException("Expected float");
-			normal.push_back(norm_coordinate);
-			norm_coord_num += 1;
-		}
-	} else {
-		throw new StrException("Expected 'normal'");
-	}
-	
-	// coordinate part
-	int base = coord.size()/3;
-	if (!tkn.expecting("outer") || !tkn.expecting("loop")) throw new StrException("Expected 'outer loop'");
-	
-	for (int i_line=0; i_line < 3; i_line++){
-		if (tkn.expecting("vertex")) {
-			float coordinate;
-			int coord_num = 0;
-			while(coord_num < 3){
-				if (tkn.getFloat(coordinate)){
-					coord.push_back(coordinate);
-					coord_num += 1;
-				} else {
-					throw new StrException("Expected float");
-				}
-			}
-			coordIndex.push_back(base + i_line);
-		} else {
-			throw new StrException("Expected 'vertex'");
-		}
-	}
-	coordIndex.push_back(-1);
-	
-	// end loop
-	if (!tkn.expecting("endloop")) throw new StrException("Expected 'endloop'");
-	
-	// end facet
-    if (!tkn.expecting("endfacet")) throw new StrException("Expected 'endfacet'");
-
-	return true;
+// binary STL layout: 80 byte header, uint32 number of triangles, and
+// 50 bytes per triangle : 12 little endian floats (normal and three
+// vertices) followed by a uint16 attribute byte count
+#define STL_HEADER_SIZE   84
+#define STL_TRIANGLE_SIZE 50
+
+//////////////////////////////////////////////////////////////////////
+// ASCII scanning over the mapped bytes
+
+static inline bool isSpace(const char c) {
+  return c==' ' || c=='\n' || c=='\r' || c=='\t' || c=='\f' || c=='\v';
+}
+
+static inline void skipSpace(const char*& p, const char* end) {
+  while(p<end && isSpace(*p)) p++;
+}
+
+// consumes the next token if it is equal to the given keyword
+static inline bool expecting(const char*& p, const char* end, const char* keyword) {
+  skipSpace(p,end);
+  size_t n = strlen(keyword);
+  if((size_t)(end-p)<n || memcmp(p,keyword,n)!=0) return false;
+  if(p+n<end && !isSpace(p[n])) return false;
+  p += n;
+  return true;
+}
+
+static inline bool getFloat(const char*& p, const char* end, float& f) {
+  skipSpace(p,end);
+  // the mapped bytes are not NUL terminated; copy the token so that
+  // strtof cannot read past the end of the file
+  char  buf[64];
+  size_t n = 0;
+  while(p+n<end && !isSpace(p[n]) && n<sizeof(buf)-1) { buf[n] = p[n]; n++; }
+  if(n==0) return false;
+  buf[n] = '\0';
+  char* last = (char*)0;
+  f = strtof(buf,&last);
+  if(last!=buf+n) return false;
+  p += n;
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+bool LoaderStl::isBinary(const char* data, const size_t size) {
+  if(size<STL_HEADER_SIZE) return false;
+  uint32_t nT;
+  memcpy(&nT,data+80,4);
+  uint64_t binarySize = STL_HEADER_SIZE+STL_TRIANGLE_SIZE*(uint64_t)nT;
+  if(binarySize==(uint64_t)size) return true;
+  // not an exact binary file size; ASCII files must start with "solid"
+  const char* p   = data;
+  const char* end = data+size;
+  if(!expecting(p,end,"solid")) return true;
+  // some exporters also write "solid" in the header of binary files,
+  // which may be followed by padding; in ASCII files the "solid" line
+  // is followed by a facet, or by the end of an empty solid
+  if(binarySize>(uint64_t)size) return false;
+  const char* eol = (const char*)memchr(p,'\n',(size_t)(end-p));
+  if(eol==(const char*)0) return true;
+  p = eol+1;
+  return !expecting(p,end,"facet") && !expecting(p,end,"endsolid");
+}
+
+void LoaderStl::loadBinary
+(const char* data, const size_t size,
+ vector<float>& normal, vector<float>& coord, vector<int>& coordIndex) {
+
+  uint32_t nT;
+  memcpy(&nT,data+80,4);
+  if(STL_HEADER_SIZE+STL_TRIANGLE_SIZE*(uint64_t)nT>(uint64_t)size)
+    throw new StrException("truncated binary STL file");
+
+  normal.resize(3*(size_t)nT);
+  coord.resize(9*(size_t)nT);
+  coordIndex.resize(4*(size_t)nT);
+
+  const char* p = data+STL_HEADER_SIZE;
+  float* n = normal.data();
+  float* v = coord.data();
+  int*   c = coordIndex.data();
+  for(uint32_t iT=0;iT<nT;iT++,p+=STL_TRIANGLE_SIZE) {
+    if((iT&0xffff)==0) progress((size_t)(p-data),size);
+    memcpy(n+3*(size_t)iT,p   ,12);
+    memcpy(v+9*(size_t)iT,p+12,36);
+    int iV = 3*(int)iT;
+    c[4*(size_t)iT  ] = iV;
+    c[4*(size_t)iT+1] = iV+1;
+    c[4*(size_t)iT+2] = iV+2;
+    c[4*(size_t)iT+3] = -1;
+  }
+
+  // the file is little endian
+  const uint16_t one = 1;
+  if(*((const uint8_t*)&one)==0) {
+    vector<float>* arrays[2] = { &normal, &coord };
+    for(int k=0;k<2;k++) {
+      uint8_t* b = (uint8_t*)arrays[k]->data();
+      for(size_t i=0;i<arrays[k]->size();i++,b+=4) {
+        uint8_t t;
+        t = b[0]; b[0] = b[3]; b[3] = t;
+        t = b[1]; b[1] = b[2]; b[2] = t;
+      }
+    }
+  }
+}
+
+void LoaderStl::loadAscii
+(const char* data, const size_t size,
+ vector<float>& normal, vector<float>& coord, vector<int>& coordIndex) {
+
+  // each facet takes more than 200 bytes in a typical file
+  size_t nT = size/200+1;
+  normal.reserve(3*nT);
+  coord.reserve(9*nT);
+  coordIndex.reserve(4*nT);
+
+  const char* p   = data;
+  const char* end = data+size;
+
+  if(!expecting(p,end,"solid")) throw new StrException("Expected 'solid'");
+  // the solid name is optional, and extends to the end of the line
+  while(p<end && *p!='\n') p++;
+
+  float f[3];
+  while(true) {
+    if(expecting(p,end,"endsolid")) break;
+    skipSpace(p,end);
+    if(p==end) break; // missing endsolid
+    if(!expecting(p,end,"facet"))
+      throw new StrException("Expected 'facet' or 'endsolid'");
+
+    // facet normal ni nj nk
+    if(!expecting(p,end,"normal")) throw new StrException("Expected 'normal'");
+    if(!getFloat(p,end,f[0]) || !getFloat(p,end,f[1]) || !getFloat(p,end,f[2]))
+      throw new StrException("Expected float");
+    normal.insert(normal.end(),f,f+3);
+
+    //   outer loop
+    if(!expecting(p,end,"outer") || !expecting(p,end,"loop"))
+      throw new StrException("Expected 'outer loop'");
+
+    //     vertex vx vy vz (x3)
+    int iV = (int)(coord.size()/3);
+    for(int j=0;j<3;j++) {
+      if(!expecting(p,end,"vertex")) throw new StrException("Expected 'vertex'");
+      if(!getFloat(p,end,f[0]) || !getFloat(p,end,f[1]) || !getFloat(p,end,f[2]))
+        throw new StrException("Expected float");
+      coord.insert(coord.end(),f,f+3);
+      coordIndex.push_back(iV+j);
+    }
+    coordIndex.push_back(-1);
+    if((coordIndex.size()&0x3ffff)==0) progress((size_t)(p-data),size);
+
+    //   endloop
+    // endfacet
+    if(!expecting(p,end,"endloop"))  throw new StrException("Expected 'endloop'");
+    if(!expecting(p,end,"endfacet")) throw new StrException("Expected 'endfacet'");
+  }
+}
+
+void LoaderStl::setWeldVertices(const bool weld, const float epsilon) {
+  _weld        = weld;
+  _weldEpsilon = (epsilon>0.0f)?epsilon:0.0f;
 }
 
 bool LoaderStl::load(const char* filename, SceneGraph& wrl) {
@@ -105,99 +228,47 @@ bool LoaderStl::load(const char* filename, SceneGraph& wrl) {
   wrl.clear();
   wrl.setUrl("");
 
-  FILE* fp = (FILE*)0;
+  FileMap file;
   try {
 
-    // open the file
+    // map the file
     if(filename==(char*)0) throw new StrException("filename==null");
-    fp = fopen(filename,"r");
-    if(fp==(FILE*)0) throw new StrException("fp==(FILE*)0");
-
-    // use the io/Tokenizer class to parse the input ascii file
-    TokenizerFile tkn(fp);
-	
-    // first token should be "solid"
-    if(tkn.expecting("solid") && tkn.get()) {
-      string stlName = tkn; // second token should be the solid name
-
-      // TODO ...
-
-      // create the scene graph structure :
-      // 1) the SceneGraph should have a single Shape node a child
-      // 2) the Shape node should have an Appearance node in its appearance field
-      // 3) the Appearance node should have a Material node in its material field
-      // 4) the Shape node should have an IndexedFaceSet node in its geometry node
-      // from the IndexedFaceSet
-      // 5) get references to the coordIndex, coord, and normal arrays
-      // 6) set the normalPerVertex variable to false (i.e., normals per face)  
-
-      // Create a shape children node for scene graph
-	  // whole shape
-	  Shape* child_node = new Shape();
-	  // Appearance node
-	  Appearance* child_node_appearance = new Appearance();
-	  Material* child_node_appearance_material = new Material();
-	  child_node_appearance->setMaterial(child_node_appearance_material);
-	  // IndexedFaceSet node
-	  IndexedFaceSet* child_node_geometry = new IndexedFaceSet();
-	  // store them back to shape
-	  child_node->setAppearance(child_node_appearance);
-	  child_node->setGeometry(child_node_geometry);
-	  
-	  // assign them to scene graph
-	  wrl.addChild(child_node);
-
-      // get references to coordIndex, coord, normal arrays
-	  std::vector<int>& child_node_coordIndex = child_node_geometry->getCoordIndex();
-	  std::vector<float>& child_node_coord = child_node_geometry->getCoord();
-	  std::vector<float>& child_node_normal = child_node_geometry->getNormal();
-	  
-	  // set the normalPerVertex as false
-	  child_node_geometry->setNormalPerVertex(false);
-	  
-	  // parsing the file
-	  if (!tkn.get()) throw new StrException("Unexpected EOF after 'solid <name>'");
-	  while (true){
-		  if (tkn.equals("facet")){
-			loadFace(tkn, child_node_normal, child_node_coord, child_node_coordIndex);
-			if (!tkn.get()){
-				success = true;
-				break;
-			}
-		  } else if(tkn.equals("endsolid")){
-			  success = true;
-			  break;
-		  } else {
-			  throw new StrException("Expected 'facet' or 'endsolid'");
-		  }
-	  }
-
-      // the file should contain a list of triangles in the following format
-
-      // facet normal ni nj nk
-      //   outer loop
-      //     vertex v1x v1y v1z
-      //     vertex v2x v2y v2z
-      //     vertex v3x v3y v3z
-      //   endloop
-      // endfacet
-
-      // - run an infinite loop to parse all the faces
-      // - write a private method to parse each face within the loop
-      // - the method should return true if successful, and false if not
-      // - if your method returns tru
-      //     update the normal, coord, and coordIndex variables
-      // - if your method returns false
-      //     throw an StrException explaining why the method failed
+    if(file.open(filename)==false) throw new StrException("cannot open file");
+
+    // create the scene graph structure :
+    // 1) the SceneGraph has a single Shape node a child
+    // 2) the Shape node has an Appearance node in its appearance field
+    // 3) the Appearance node has a Material node in its material field
+    // 4) the Shape node has an IndexedFaceSet node in its geometry node
+    // 5) normalPerVertex is set to false (i.e., normals per face)
+    Shape* shape = new Shape();
+    Appearance* appearance = new Appearance();
+    appearance->setMaterial(new Material());
+    shape->setAppearance(appearance);
+    IndexedFaceSet* ifs = new IndexedFaceSet();
+    ifs->setNormalPerVertex(false);
+    shape->setGeometry(ifs);
+    wrl.addChild(shape);
 
+    vector<float>& normal     = ifs->getNormal();
+    vector<float>& coord      = ifs->getCoord();
+    vector<int>&   coordIndex = ifs->getCoordIndex();
+
+    if(isBinary(file.getData(),file.getSize()))
+      loadBinary(file.getData(),file.getSize(),normal,coord,coordIndex);
+    else
+      loadAscii(file.getData(),file.getSize(),normal,coord,coordIndex);
+
+    // the normals are bound per face, and are not affected
+    if(_weld) {
+      VertexWeld weld(_weldEpsilon);
+      weld.apply(coord,coordIndex);
     }
 
-    // close the file (this statement may not be reached)
-    fclose(fp);
-    
+    success = true;
+
   } catch(StrException* e) { 
     
-    if(fp!=(FILE*)0) fclose(fp);
     fprintf(stderr,"ERROR | %s\n",e->what());
     delete e;
 
@@ -205,4 +276,3 @@ bool LoaderStl::load(const char* filename, SceneGraph& wrl) {
 
   return success;
 }
-
@@ -37,23 +37,53 @@
 #ifndef _LOADER_STL_HPP_
 #define _LOADER_STL_HPP_
 
+#include <stddef.h>
+#include <vector>
+
 #include "Loader.hpp"
-#include "Tokenizer.hpp"
 
 #include "wrl/Node.hpp"
 
+// Reads both ASCII and binary STL files. The file is memory mapped and
+// parsed in place; binary files are recognized by the size implied by
+// the triangle count stored in the 84 byte header, so that binary
+// files whose header happens to start with "solid" are not mistaken
+// for ASCII files. As in the STL file, every facet gets three new
+// vertices, and one normal per face, unless vertex welding is enabled
+// (see core/VertexWeld).
+
 class LoaderStl : public Loader {
 
 private:
 
   const static char* _ext;
-  bool loadFace(Tokenizer&tkn, std::vector<float>& normal, std::vector<float>& coord, std::vector<int>& coordIndex);
+
+  bool  _weld;
+  float _weldEpsilon;
+
+  static bool isBinary(const char* data, const size_t size);
+
+  void loadBinary(const char* data, const size_t size,
+                  std::vector<float>& normal,
+                  std::vector<float>& coord,
+                  std::vector<int>& coordIndex);
+
+  void loadAscii(const char* data, const size_t size,
+                 std::vector<float>& normal,
+                 std::vector<float>& coord,
+                 std::vector<int>& coordIndex);
   
 public:
 
-  LoaderStl()  {};
+  LoaderStl():_weld(false),_weldEpsilon(0.0f) {};
   ~LoaderStl() {};
 
+  // if weld==true, merge the vertices closer than epsilon after
+  // loading; epsilon==0 merges only equal vertices
+  void  setWeldVertices(const bool weld, const float epsilon=0.0f);
+  bool  getWeldVertices() const { return _weld; }
+  float getWeldEpsilon()  const { return _weldEpsilon; }
+
   bool  load(const char* filename, SceneGraph& wrl);
   const char* ext() const { return _ext; }
 
@@ -0,0 +1,331 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// LoaderWrb.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <stdio.h>
+#include <string.h>
+#include "FileMap.hpp"
+#include "LoaderWrb.hpp"
+#include "StrException.hpp"
+#include "WrbFormat.hpp"
+
+#include <wrl/Transform.hpp>
+#include <wrl/Shape.hpp>
+#include <wrl/Appearance.hpp>
+#include <wrl/Material.hpp>
+#include <wrl/ImageTexture.hpp>
+#include <wrl/IndexedFaceSet.hpp>
+#include <wrl/IndexedLineSet.hpp>
+
+const char* LoaderWrb::_ext = "wrb";
+
+//////////////////////////////////////////////////////////////////////
+// bounds checked binary input from the mapped file
+
+class WrbReader {
+
+public:
+
+  WrbReader(const char* data, const size_t size):
+    _data(data),_size(size),_offset(0) { }
+
+  size_t getOffset() const { return _offset; }
+  size_t getSize()   const { return _size;   }
+
+  void get(void* dst, const size_t size) {
+    if(size>_size-_offset) throw new StrException("unexpected end of file");
+    if(size>0) memcpy(dst,_data+_offset,size);
+    _offset += size;
+  }
+
+  uint32_t getU32() { uint32_t u; get(&u,4); return u; }
+  uint64_t getU64() { uint64_t u; get(&u,8); return u; }
+  float    getF32() { float    f; get(&f,4); return f; }
+
+  void getVec3f(Vec3f& v) { v.x = getF32(); v.y = getF32(); v.z = getF32(); }
+  void getColor(Color& c) { c.r = getF32(); c.g = getF32(); c.b = getF32(); }
+
+  void getString(string& s) {
+    uint32_t n = getU32();
+    if(n>_size-_offset) throw new StrException("unexpected end of file");
+    s.assign(_data+_offset,n);
+    _offset += n;
+  }
+
+  void align() {
+    size_t r = _offset%WrbFormat::ALIGNMENT;
+    if(r>0) _offset += WrbFormat::ALIGNMENT-r;
+    if(_offset>_size) throw new StrException("unexpected end of file");
+  }
+
+  template<class T> void getArray(vector<T>& v) {
+    uint64_t n = getU64();
+    align();
+    if(n>(_size-_offset)/sizeof(T))
+      throw new StrException("unexpected end of file");
+    const T* first = (const T*)(_data+_offset);
+    v.assign(first,first+n);
+    _offset += n*sizeof(T);
+  }
+
+private:
+
+  const char* _data;
+  size_t      _size;
+  size_t      _offset;
+
+};
+
+//////////////////////////////////////////////////////////////////////
+void LoaderWrb::loadChildren(WrbReader& in, Group& group) {
+  uint32_t nChildren = in.getU32();
+  for(uint32_t i=0;i<nChildren;i++) {
+    Node* child = loadNode(in);
+    if(child==(Node*)0 || !(child->isShape() || child->isGroup())) {
+      delete child;
+      throw new StrException("unexpected group child");
+    }
+    group.addChild(child);
+    progress(in.getOffset(),in.getSize());
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+Node* LoaderWrb::loadNode(WrbReader& in) {
+
+  uint32_t tag = in.getU32();
+  if(tag==WrbFormat::NODE_NULL) return (Node*)0;
+
+  string name;
+  in.getString(name);
+
+  // the partially loaded node is deleted if an error is found
+  Node* node = (Node*)0;
+  try {
+    switch(tag) {
+
+    case WrbFormat::NODE_GROUP:
+      {
+        Group* group = new Group();
+        node = group;
+        Vec3f bboxCenter,bboxSize;
+        in.getVec3f(bboxCenter);
+        in.getVec3f(bboxSize);
+        group->setBBoxCenter(bboxCenter);
+        group->setBBoxSize(bboxSize);
+        loadChildren(in,*group);
+      }
+      break;
+
+    case WrbFormat::NODE_TRANSFORM:
+      {
+        Transform* transform = new Transform();
+        node = transform;
+        Vec3f v;
+        in.getVec3f(transform->getCenter());
+        in.getVec3f(v);
+        transform->getRotation().set(v.x,v.y,v.z,in.getF32());
+        in.getVec3f(transform->getScale());
+        in.getVec3f(v);
+        transform->getScaleOrientation().set(v.x,v.y,v.z,in.getF32());
+        in.getVec3f(transform->getTranslation());
+        in.getVec3f(transform->getBBoxCenter());
+        in.getVec3f(transform->getBBoxSize());
+        loadChildren(in,*transform);
+      }
+      break;
+
+    case WrbFormat::NODE_SHAPE:
+      {
+        Shape* shape = new Shape();
+        node = shape;
+        Node* appearance = loadNode(in);
+        if(appearance!=(Node*)0 && !appearance->isAppearance()) {
+          delete appearance;
+          throw new StrException("unexpected Shape appearance");
+        }
+        if(appearance!=(Node*)0) shape->setAppearance(appearance);
+        Node* geometry = loadNode(in);
+        if(geometry!=(Node*)0 &&
+           !geometry->isIndexedFaceSet() && !geometry->isIndexedLineSet()) {
+          delete geometry;
+          throw new StrException("unexpected Shape geometry");
+        }
+        if(geometry!=(Node*)0) shape->setGeometry(geometry);
+      }
+      break;
+
+    case WrbFormat::NODE_APPEARANCE:
+      {
+        Appearance* appearance = new Appearance();
+        node = appearance;
+        Node* material = loadNode(in);
+        if(material!=(Node*)0 && !material->isMaterial()) {
+          delete material;
+          throw new StrException("unexpected Appearance material");
+        }
+        if(material!=(Node*)0) appearance->setMaterial(material);
+        Node* texture = loadNode(in);
+        if(texture!=(Node*)0 && !texture->isImageTexture()) {
+          delete texture;
+          throw new StrException("unexpected Appearance texture");
+        }
+        if(texture!=(Node*)0) appearance->setTexture(texture);
+      }
+      break;
+
+    case WrbFormat::NODE_MATERIAL:
+      {
+        Material* material = new Material();
+        node = material;
+        Color c;
+        material->setAmbientIntensity(in.getF32());
+        in.getColor(c);
+        material->setDiffuseColor(c);
+        in.getColor(c);
+        material->setEmissiveColor(c);
+        material->setShininess(in.getF32());
+        in.getColor(c);
+        material->setSpecularColor(c);
+        material->setTransparency(in.getF32());
+      }
+      break;
+
+    case WrbFormat::NODE_IMAGE_TEXTURE:
+      {
+        ImageTexture* imageTexture = new ImageTexture();
+        node = imageTexture;
+        uint32_t flags = in.getU32();
+        imageTexture->setRepeatS((flags&WrbFormat::FLAG_REPEAT_S)!=0);
+        imageTexture->setRepeatT((flags&WrbFormat::FLAG_REPEAT_T)!=0);
+        uint32_t nUrl = in.getU32();
+        string url;
+        for(uint32_t i=0;i<nUrl;i++) {
+          in.getString(url);
+          imageTexture->adToUrl(url);
+        }
+      }
+      break;
+
+    case WrbFormat::NODE_INDEXED_FACE_SET:
+      {
+        IndexedFaceSet* ifs = new IndexedFaceSet();
+        node = ifs;
+        uint32_t flags = in.getU32();
+        ifs->getCcw()             = (flags&WrbFormat::FLAG_CCW)!=0;
+        ifs->getConvex()          = (flags&WrbFormat::FLAG_CONVEX)!=0;
+        ifs->getSolid()           = (flags&WrbFormat::FLAG_SOLID)!=0;
+        ifs->getNormalPerVertex() = (flags&WrbFormat::FLAG_NORMAL_PER_VERTEX)!=0;
+        ifs->getColorPerVertex()  = (flags&WrbFormat::FLAG_COLOR_PER_VERTEX)!=0;
+        ifs->getCreaseangle()     = in.getF32();
+        in.getArray(ifs->getCoord());
+        in.getArray(ifs->getCoordIndex());
+        in.getArray(ifs->getNormal());
+        in.getArray(ifs->getNormalIndex());
+        in.getArray(ifs->getColor());
+        in.getArray(ifs->getColorIndex());
+        in.getArray(ifs->getTexCoord());
+        in.getArray(ifs->getTexCoordIndex());
+      }
+      break;
+
+    case WrbFormat::NODE_INDEXED_LINE_SET:
+      {
+        IndexedLineSet* ils = new IndexedLineSet();
+        node = ils;
+        uint32_t flags = in.getU32();
+        ils->getColorPerVertex()  = (flags&WrbFormat::FLAG_COLOR_PER_VERTEX)!=0;
+        in.getArray(ils->getCoord());
+        in.getArray(ils->getCoordIndex());
+        in.getArray(ils->getColor());
+        in.getArray(ils->getColorIndex());
+      }
+      break;
+
+    default:
+      throw new StrException("unknown node tag");
+    }
+  } catch(StrException* e) {
+    delete node;
+    throw e;
+  }
+
+  node->setName(name);
+  return node;
+}
+
+//////////////////////////////////////////////////////////////////////
+bool LoaderWrb::load(const char* filename, SceneGraph& wrl) {
+  bool success = false;
+
+  FileMap file;
+  try {
+
+    // open the file
+    if(filename==(char*)0) throw new StrException("filename==null");
+    if(file.open(filename)==false) throw new StrException("cannot open file");
+
+    // clear the container
+    wrl.clear();
+    wrl.setUrl(filename);
+
+    // read and check the header
+    WrbReader in(file.getData(),file.getSize());
+    char magic[8];
+    in.get(magic,8);
+    if(memcmp(magic,WrbFormat::magic(),8)!=0)
+      throw new StrException("not a wrb file");
+    if(in.getU32()!=WrbFormat::VERSION)
+      throw new StrException("unsupported wrb version");
+    if(in.getU32()!=WrbFormat::BYTE_ORDER_MARK)
+      throw new StrException("wrb file written with a different byte order");
+    if(in.getU64()!=(uint64_t)file.getSize())
+      throw new StrException("truncated wrb file");
+    in.getU64();
+
+    loadChildren(in,wrl);
+
+    // if we have reached this point we have succeeded
+    success = true;
+
+  } catch(StrException* e) { 
+
+    fprintf(stderr,"ERROR | %s\n",e->what());
+    delete e;
+    wrl.clear();
+    wrl.setUrl("");
+
+  }
+
+  return success;
+}
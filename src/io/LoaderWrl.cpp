@@ -33,7 +33,9 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <stdio.h>
-#include "TokenizerFile.hpp"
+#include <string.h>
+#include "FileMap.hpp"
+#include "TokenizerBuffer.hpp"
 #include "LoaderWrl.hpp"
 #include "StrException.hpp"
 
@@ -41,6 +43,10 @@
 
 const char* LoaderWrl::_ext = "wrl";
 
+void LoaderWrl::updateProgress(Tokenizer& tkn) {
+  progress(_offset+tkn.getPosition(),_size);
+}
+
 bool LoaderWrl::loadSceneGraph(Tokenizer& tkn, SceneGraph& wrl) {
 
   string name    = "";
@@ -636,36 +642,17 @@ bool LoaderWrl::loadIndexedLineSet(Tokenizer& tkn, IndexedLineSet& ifs) {
 }
 
 bool LoaderWrl::loadVecFloat(Tokenizer&tkn,vector<float>& vec) {
-  bool success = false;
   if(tkn.expecting("[")==false) throw new StrException("expecting \"[\"");
-  float value;
-  while(success==false && tkn.get()) {
-    if(tkn.equals("]")) {
-      success = true; // done
-    } else if(sscanf(tkn.c_str(),"%f",&value)==1) {
-      vec.push_back(value);
-    } else {
-      throw new StrException("expecting int value");
-    }
-  }
-
-  return success;
+  if(tkn.getVecFloat(vec)==false) throw new StrException("expecting float value");
+  updateProgress(tkn);
+  return true;
 }
 
 bool LoaderWrl::loadVecInt(Tokenizer&tkn,vector<int>& vec) {
-  bool success = false;
   if(tkn.expecting("[")==false) throw new StrException("expecting \"[\"");
-  int value;
-  while(success==false && tkn.get()) {
-    if(tkn.equals("]")) {
-      success = true; // done
-    } else if(sscanf(tkn.c_str(),"%d",&value)==1) {
-      vec.push_back(value);
-    } else {
-      throw new StrException("expecting int value");
-    }
-  }
-  return success;
+  if(tkn.getVecInt(vec)==false) throw new StrException("expecting int value");
+  updateProgress(tkn);
+  return true;
 }
 
 bool LoaderWrl::loadVecString(Tokenizer&tkn,vector<string>& vec) {
@@ -692,39 +679,40 @@ bool LoaderWrl::loadVecString(Tokenizer&tkn,vector<string>& vec) {
 bool LoaderWrl::load(const char* filename, SceneGraph& wrl) {
   bool success = false;
 
-  FILE* fp = (FILE*)0;
+  // the file is memory mapped, so that the large numeric arrays can
+  // be parsed in parallel
+  FileMap file;
   try {
 
     // open the file
     if(filename==(char*)0) throw new StrException("filename==null");
-    fp = fopen(filename,"r");
-    if(fp==(FILE*)0) throw new StrException("fp==(FILE*)0");
+    if(file.open(filename)==false) throw new StrException("cannot open file");
 
     // clear the container
     wrl.clear();
     wrl.setUrl(filename);
 
     // read and check header line
-    char header[16];
-    // memset(header,'\0',16);
-    for(int i=0;i<16;i++) header[i] = '\0';
-    fscanf(fp,"%15c",header);
-    if(string(header)!=VRML_HEADER) throw new StrException("header!=VRM_HEADER");
+    size_t headerSize = strlen(VRML_HEADER);
+    if(file.getSize()<headerSize ||
+       memcmp(file.getData(),VRML_HEADER,headerSize)!=0)
+      throw new StrException("header!=VRM_HEADER");
 
     // create a Tokenizer and start parsing
-    TokenizerFile tkn(fp);
+    TokenizerBuffer tkn(file.getData()+headerSize,file.getSize()-headerSize);
+    _offset = headerSize;
+    _size   = file.getSize();
+    updateProgress(tkn);
     loadSceneGraph(tkn,wrl);
 
     // will be done later
     // wrl.updateBBox();
     
     // if we have reached this point we have succeeded
-    fclose(fp);
     success = true;
 
   } catch(StrException* e) { 
 
-    if(fp!=(FILE*)0) fclose(fp);
     fprintf(stderr,"ERROR | %s\n",e->what());
     delete e;
     wrl.clear();
@@ -734,4 +722,3 @@ bool LoaderWrl::load(const char* filename, SceneGraph& wrl) {
 
   return success;
 }
-
@@ -51,9 +51,14 @@ private:
 
   const static char* _ext;
 
+  // file offset of the tokenizer input, and file size, of the current
+  // load, for the progress reports
+  size_t _offset;
+  size_t _size;
+
 public:
 
-  LoaderWrl()  {};
+  LoaderWrl():_offset(0),_size(0) {};
   ~LoaderWrl() {};
 
   bool  load(const char* filename, SceneGraph& wrl);
@@ -61,6 +66,7 @@ public:
 
 private:
 
+  void updateProgress(Tokenizer& tkn);
   bool loadSceneGraph(Tokenizer& tkn, SceneGraph& wrl);
   bool loadGroup(Tokenizer& tkn, Group& group);
   bool loadTransform(Tokenizer& tkn, Transform& transform);
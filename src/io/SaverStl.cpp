@@ -34,6 +34,11 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+
 #include "SaverStl.hpp"
 
 #include "wrl/Shape.hpp"
@@ -41,137 +46,255 @@
 #include "wrl/Material.hpp"
 #include "wrl/IndexedFaceSet.hpp"
 
-#include "core/Faces.hpp"
-
 const char* SaverStl::_ext = "stl";
 
 //////////////////////////////////////////////////////////////////////
-void SaverStl::saveFace
-(FILE* fp, const Faces& faces, int face_id, vector<float>& coord, vector<float>& Normal) const {
-  // if the normal vector is empty, just return the function
-  if(Normal.size() == 0) return;
-  
-  // Normap Vector Part //
-  // write normal vector
-  fprintf(fp, " facet normal %f %f %f\n", Normal[3*face_id], Normal[3*face_id+1], Normal[3*face_id+2]);
-
-  // Vertices Part //
-  // write vertices
-  fprintf(fp, "  outer loop\n");
-  // loop through each vertices
-  int number_vertices = faces.getFaceSize(face_id);
-  if (number_vertices < 3) return;
-  
-  for (int i_vertices = 0; i_vertices < number_vertices; i_vertices++){
-	  // retrieve current vertex index
-	  int current_coordIndex = faces.getFaceVertex(face_id, i_vertices);
-	  // write the vertex
-	  fprintf(fp, "   vertex %f %f %f\n", coord[3*current_coordIndex], coord[3*current_coordIndex+1], coord[3*current_coordIndex+2]);	  
+// output buffer, written to the file with fwrite in large blocks
+
+class StlBuffer {
+
+public:
+
+  // the buffer is on the heap, as the savers may run in threads with
+  // small stacks
+  StlBuffer(FILE* fp):_fp(fp),_n(0),_ok(true),_buf(1<<18) { }
+
+  bool flush() {
+    if(_n>0 && fwrite(_buf.data(),1,_n,_fp)!=_n) _ok = false;
+    _n = 0;
+    return _ok;
+  }
+
+  void put(const char* s, const size_t n) {
+    if(_n+n>_buf.size()) flush();
+    memcpy(_buf.data()+_n,s,n);
+    _n += n;
+  }
+
+  void put(const char* s) {
+    put(s,strlen(s));
+  }
+
+  // same output as fprintf "%f", without the printf overhead; for a
+  // float x the product x*1e6 is exact in double precision, and rint
+  // rounds half to even, as printf does
+  void putFloat(const float f) {
+    double x = (double)f;
+    if(!(fabs(x)<1.0e12)) { // very large values, inf and nan
+      char tmp[64];
+      int  n = snprintf(tmp,sizeof(tmp),"%f",x);
+      put(tmp,(size_t)n);
+      return;
+    }
+    if(_n+32>_buf.size()) flush();
+    char* p = _buf.data()+_n;
+    if(signbit(x)) { *p++ = '-'; x = -x; }
+    uint64_t v  = (uint64_t)rint(x*1.0e6);
+    uint64_t iP = v/1000000;
+    uint64_t fP = v%1000000;
+    char t[24];
+    int  k = 0;
+    do { t[k++] = (char)('0'+iP%10); iP /= 10; } while(iP>0);
+    while(k>0) *p++ = t[--k];
+    *p++ = '.';
+    for(k=5;k>=0;k--) { p[k] = (char)('0'+fP%10); fP /= 10; }
+    _n = (size_t)(p+6-_buf.data());
+  }
+
+  // binary STL values are little endian
+  void putUInt32(const uint32_t u) {
+    unsigned char b[4];
+    b[0] = (unsigned char)(u    ); b[1] = (unsigned char)(u>> 8);
+    b[2] = (unsigned char)(u>>16); b[3] = (unsigned char)(u>>24);
+    put((const char*)b,4);
+  }
+
+  void putFloat32(const float f) {
+    uint32_t u;
+    memcpy(&u,&f,4);
+    putUInt32(u);
+  }
+
+  void putUInt16(const uint16_t u) {
+    unsigned char b[2];
+    b[0] = (unsigned char)(u); b[1] = (unsigned char)(u>>8);
+    put((const char*)b,2);
+  }
+
+private:
+
+  FILE*        _fp;
+  size_t       _n;
+  bool         _ok;
+  vector<char> _buf;
+
+};
+
+//////////////////////////////////////////////////////////////////////
+// iterates over the triangles of the IndexedFaceSet faces, splitting
+// polygons into triangle fans
+
+class StlTriangles {
+
+public:
+
+  StlTriangles(IndexedFaceSet& ifs):
+    _coord(ifs.getCoord()),
+    _coordIndex(ifs.getCoordIndex()),
+    _normal(ifs.getNormal()),
+    _normalIndex(ifs.getNormalIndex()),
+    _binding(ifs.getNormalBinding()),
+    _iF(-1),_i0(0),_i1(-1),_j(0) {
+  }
+
+  // number of triangles written by the iteration
+  uint32_t count() {
+    uint32_t nT = 0;
+    while(next()) nT++;
+    _iF = -1; _i0 = 0; _i1 = -1; _j = 0;
+    return nT;
+  }
+
+  bool next() {
+    if(_i1>=0 && _i0+_j+3<_i1) { _j++; return nextTriangle(); }
+    // find the next face with at least three valid corners
+    int nC = (int)_coordIndex.size();
+    int nV = (int)(_coord.size()/3);
+    while(_i1<nC) {
+      _i0 = _i1+1;
+      if(_i0>=nC) break;
+      _iF++;
+      bool valid = true;
+      for(_i1=_i0;_i1<nC && _coordIndex[_i1]>=0;_i1++)
+        if(_coordIndex[_i1]>=nV) valid = false;
+      if(valid && _i1-_i0>=3) { _j = 0; return nextTriangle(); }
+    }
+    _i1 = nC;
+    return false;
+  }
+
+  const float* vertex(const int k) const { return _v[k]; }
+  const float* normal()            const { return _n;    }
+
+private:
+
+  bool nextTriangle() {
+    _v[0] = &_coord[3*_coordIndex[_i0     ]];
+    _v[1] = &_coord[3*_coordIndex[_i0+_j+1]];
+    _v[2] = &_coord[3*_coordIndex[_i0+_j+2]];
+    int iN = -1;
+    if(_binding==IndexedFaceSet::PB_PER_FACE)
+      iN = _iF;
+    else if(_binding==IndexedFaceSet::PB_PER_FACE_INDEXED && _iF<(int)_normalIndex.size())
+      iN = _normalIndex[_iF];
+    if(iN>=0 && 3*iN+2<(int)_normal.size()) {
+      _n[0] = _normal[3*iN]; _n[1] = _normal[3*iN+1]; _n[2] = _normal[3*iN+2];
+    } else {
+      float e1[3],e2[3];
+      for(int k=0;k<3;k++) { e1[k] = _v[1][k]-_v[0][k]; e2[k] = _v[2][k]-_v[0][k]; }
+      _n[0] = e1[1]*e2[2]-e1[2]*e2[1];
+      _n[1] = e1[2]*e2[0]-e1[0]*e2[2];
+      _n[2] = e1[0]*e2[1]-e1[1]*e2[0];
+      float nn = sqrtf(_n[0]*_n[0]+_n[1]*_n[1]+_n[2]*_n[2]);
+      if(nn>0.0f) { _n[0] /= nn; _n[1] /= nn; _n[2] /= nn; }
+    }
+    return true;
+  }
+
+  const vector<float>&    _coord;
+  const vector<int>&      _coordIndex;
+  const vector<float>&    _normal;
+  const vector<int>&      _normalIndex;
+  IndexedFaceSet::Binding _binding;
+  int                     _iF,_i0,_i1,_j;
+  const float*            _v[3];
+  float                   _n[3];
+
+};
+
+//////////////////////////////////////////////////////////////////////
+bool SaverStl::saveAscii(FILE* fp, const string& name, IndexedFaceSet& ifs) const {
+  StlBuffer out(fp);
+  StlTriangles triangles(ifs);
+  out.put("solid "); out.put(name.c_str()); out.put("\n");
+  while(triangles.next()) {
+    const float* n = triangles.normal();
+    out.put(" facet normal ");
+    out.putFloat(n[0]); out.put(" ",1);
+    out.putFloat(n[1]); out.put(" ",1);
+    out.putFloat(n[2]); out.put("\n",1);
+    out.put("  outer loop\n");
+    for(int k=0;k<3;k++) {
+      const float* v = triangles.vertex(k);
+      out.put("   vertex ");
+      out.putFloat(v[0]); out.put(" ",1);
+      out.putFloat(v[1]); out.put(" ",1);
+      out.putFloat(v[2]); out.put("\n",1);
+    }
+    out.put("  endloop\n");
+    out.put("endfacet\n");
   }
-  // write vertices end 
-  fprintf(fp, "  endloop\n");
-  // End of Vertices //
-
-  // write normal vector end
-  fprintf(fp, "endfacet\n");
-  // End of Normal Vector //
-  
+  out.put("endsolid "); out.put(name.c_str()); out.put("\n");
+  return out.flush();
 }
 
+//////////////////////////////////////////////////////////////////////
+bool SaverStl::saveBinary(FILE* fp, const string& name, IndexedFaceSet& ifs) const {
+  StlBuffer out(fp);
+  StlTriangles triangles(ifs);
 
+  // 80 byte header; it must not start with "solid", which would make
+  // some readers take the file for an ASCII file
+  char header[80];
+  memset(header,' ',80);
+  string title = "binary STL "+name;
+  memcpy(header,title.c_str(),(title.size()<80)?title.size():80);
+  out.put(header,80);
+  out.putUInt32(triangles.count());
 
+  while(triangles.next()) {
+    const float* n = triangles.normal();
+    out.putFloat32(n[0]); out.putFloat32(n[1]); out.putFloat32(n[2]);
+    for(int k=0;k<3;k++) {
+      const float* v = triangles.vertex(k);
+      out.putFloat32(v[0]); out.putFloat32(v[1]); out.putFloat32(v[2]);
+    }
+    out.putUInt16(0);
+  }
+  return out.flush();
+}
 
 //////////////////////////////////////////////////////////////////////
 bool SaverStl::save(const char* filename, SceneGraph& wrl) const {
   bool success = false;
-  if(filename!=(char*)0) {
-    // Check these conditions
-
-    // 1) the SceneGraph should have a single child
-    // 2) the child should be a Shape node
-    // 3) the geometry of the Shape node should be an IndexedFaceSet node
-
-    // - construct an instance of the Faces class from the IndexedFaceSet
-    // - remember to delete it when you are done with it (if necessary)
-    //   before returning
-
-    // 4) the IndexedFaceSet should be a triangle mesh
-    // 5) the IndexedFaceSet should have normals per face
-
-    // if (all the conditions are satisfied) {
-
-    FILE* fp = fopen(filename,"w");
-    if(fp!=(FILE*)0) {
-		
-      // if set, use ifs->getName()
-      // otherwise use filename,
-      // but first remove directory and extension
-
-      fprintf(fp,"solid %s\n",filename);
-
-      // TODO ...
-
-	  // checking
-	  // wrl: SceneGraph Object (Group-Node based)
-		
-	  // retrieve the number of children and check if the number of children is not one
-	  // 1) check if SceneGraph only has one child
-	  int num_children = wrl.getNumberOfChildren();
-	  if (num_children != 1){
-		return false;
-	  }
-	  // create a node pointer to the child node from SceneGraph
-	  Node* child_node = wrl[0];
-	  // 2) check if the child is Shape
-	  // only process if it's a shape
-	  if (!child_node->isShape()){
-		return false;
-	  }
-	  // after checking the type cast it into shape
-	  Shape* shape_child_node = (Shape*) child_node;
-	  
-	  // 3) check if the child has IndexedFaceSet class Geometry
-	  if (!shape_child_node->hasGeometryIndexedFaceSet()){
-		return false;
-	  }	  
-		
-      // retrieve geometry (IndexedFaceSet)
-	  Node* shape_child_node_geometry = shape_child_node->getGeometry();
-	  IndexedFaceSet* shape_child_node_IndexFaceSet = (IndexedFaceSet*) shape_child_node_geometry;
-
-	  // Check geometriy Face Index Set
-	  // check if the FaceSet if Triangle Mesh
-	  // if (!shape_child_node_IndexFaceSet->isTriangleMesh()) return false;
-	  // check if the FaceSet is empty in normal vector
-	  // if (shape_child_node_IndexFaceSet->getNormal().empty()) return false;
-
-	  // necessary items
-	  std::vector<float>& coord = shape_child_node_IndexFaceSet->getCoord(); // Vertices Coordinate
-	  std::vector<int>& coordIndex = shape_child_node_IndexFaceSet->getCoordIndex(); // CoordIndex
-	  std::vector<float>& normal_vector = shape_child_node_IndexFaceSet->getNormal(); // Normal vector (maybe?)
-
-	  // set up Face object
-	  int nV = coord.size()/3;
-	  Faces child_node_faces(nV, coordIndex);
-	  	  
-	  // loop through each face
-	  int num_faces_child_node = child_node_faces.getNumberOfFaces();
-	  for (int i_face = 0; i_face < num_faces_child_node; i_face++) {
-		  saveFace(fp, child_node_faces, i_face, coord, normal_vector);
-	  }
-	  
-	  
-      // for each face {
-      //   ...
-      // }
-      
-	  fprintf(fp, "endsolid %s\n", filename);
-	  
-      fclose(fp);
-      success = true;
-    }
-    // } endif (all the conditions are satisfied)
+  if(filename==(char*)0) return false;
+
+  // 1) the SceneGraph should have a single child
+  // 2) the child should be a Shape node
+  // 3) the geometry of the Shape node should be an IndexedFaceSet node
+  if(wrl.getNumberOfChildren()!=1) return false;
+  Node* node = wrl[0];
+  if(node==(Node*)0 || node->isShape()==false) return false;
+  Shape* shape = (Shape*)node;
+  if(shape->hasGeometryIndexedFaceSet()==false) return false;
+  IndexedFaceSet* ifs = (IndexedFaceSet*)(shape->getGeometry());
+
+  // if set, use the node name as the solid name; otherwise use the
+  // filename, but first remove directory and extension
+  string name = ifs->getName();
+  if(name=="") name = shape->getName();
+  if(name=="") {
+    name = filename;
+    size_t i = name.find_last_of("/\\");
+    if(i!=string::npos) name = name.substr(i+1);
+    i = name.find_last_of('.');
+    if(i!=string::npos && i>0) name = name.substr(0,i);
+  }
 
+  FILE* fp = fopen(filename,(_binary)?"wb":"w");
+  if(fp!=(FILE*)0) {
+    success = (_binary)?saveBinary(fp,name,*ifs):saveAscii(fp,name,*ifs);
+    if(fclose(fp)!=0) success = false;
   }
   return success;
 }
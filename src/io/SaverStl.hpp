@@ -38,26 +38,45 @@
 #define _SAVER_STL_HPP_
 
 #include <cstdio>
+#include <string>
 #include "Saver.hpp"
-#include "core/Faces.hpp"
+
+class IndexedFaceSet;
+
+// Writes a scene graph with a single Shape child, whose geometry is
+// an IndexedFaceSet, as an ASCII or binary STL file. The faces are
+// streamed directly from the coordIndex array; polygons with more
+// than three corners are written as triangle fans, and faces with
+// fewer than three corners are skipped. If the IndexedFaceSet does
+// not have normals per face, the facet normals are computed from the
+// triangle vertices. The output is assembled in a memory buffer and
+// written with fwrite in large blocks.
 
 class SaverStl : public Saver {
 
 private:
 
-const static char* _ext;
+  const static char* _ext;
+
+  bool _binary;
 
 public:
 
-  SaverStl()  {};
+  SaverStl():_binary(false) {};
   ~SaverStl() {};
 
+  // select between ASCII (default) and binary output
+  void  setBinary(const bool value) { _binary = value; }
+  bool  getBinary() const { return _binary; }
+
   bool  save(const char* filename, SceneGraph& wrl) const;
   const char* ext() const { return _ext; };
   
 private:
-   
-   void saveFace(FILE* fp, const Faces& faces, int face_id, std::vector<float>& coord, std::vector<float>& Normal) const;
+
+  bool saveAscii(FILE* fp, const string& name, IndexedFaceSet& ifs) const;
+  bool saveBinary(FILE* fp, const string& name, IndexedFaceSet& ifs) const;
+
 };
 
 #endif /* _SAVER_STL_HPP_ */
@@ -0,0 +1,255 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// SaverWrb.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <stdio.h>
+#include <string.h>
+#include "SaverWrb.hpp"
+#include "WrbFormat.hpp"
+
+#include <wrl/Transform.hpp>
+#include <wrl/Shape.hpp>
+#include <wrl/Appearance.hpp>
+#include <wrl/Material.hpp>
+#include <wrl/ImageTexture.hpp>
+#include <wrl/IndexedFaceSet.hpp>
+#include <wrl/IndexedLineSet.hpp>
+
+const char* SaverWrb::_ext = "wrb";
+
+//////////////////////////////////////////////////////////////////////
+// binary output, which keeps track of the file offset for alignment
+
+class WrbWriter {
+
+public:
+
+  WrbWriter(FILE* fp):_fp(fp),_offset(0),_ok(true) { }
+
+  bool   ok()     const { return _ok; }
+  size_t offset() const { return _offset; }
+
+  void put(const void* data, const size_t size) {
+    if(size>0 && fwrite(data,1,size,_fp)!=size) _ok = false;
+    _offset += size;
+  }
+
+  void putU32(const uint32_t u) { put(&u,4); }
+  void putU64(const uint64_t u) { put(&u,8); }
+  void putF32(const float f)    { put(&f,4); }
+
+  void putVec3f(Vec3f& v) { putF32(v.x); putF32(v.y); putF32(v.z); }
+  void putColor(Color& c) { putF32(c.r); putF32(c.g); putF32(c.b); }
+
+  void putString(const string& s) {
+    putU32((uint32_t)s.size());
+    put(s.data(),s.size());
+  }
+
+  void align() {
+    static const char zero[WrbFormat::ALIGNMENT] = { 0 };
+    size_t r = _offset%WrbFormat::ALIGNMENT;
+    if(r>0) put(zero,WrbFormat::ALIGNMENT-r);
+  }
+
+  template<class T> void putArray(const vector<T>& v) {
+    putU64((uint64_t)v.size());
+    align();
+    put(v.data(),v.size()*sizeof(T));
+  }
+
+private:
+
+  FILE*  _fp;
+  size_t _offset;
+  bool   _ok;
+
+};
+
+//////////////////////////////////////////////////////////////////////
+static bool isSaved(Node* node) {
+  return node!=(Node*)0 && (node->isShape() || node->isGroup());
+}
+
+void SaverWrb::saveChildren(WrbWriter& out, Group* group) const {
+  uint32_t nChildren = 0;
+  int i,n = group->getNumberOfChildren();
+  for(i=0;i<n;i++)
+    if(isSaved((*group)[i])) nChildren++;
+  out.putU32(nChildren);
+  for(i=0;i<n;i++)
+    if(isSaved((*group)[i])) saveNode(out,(*group)[i]);
+}
+
+//////////////////////////////////////////////////////////////////////
+void SaverWrb::saveNode(WrbWriter& out, Node* node) const {
+
+  if(node==(Node*)0) {
+    out.putU32(WrbFormat::NODE_NULL);
+    return;
+  }
+
+  if(node->isTransform()) {
+    Transform* transform = (Transform*)node;
+    out.putU32(WrbFormat::NODE_TRANSFORM);
+    out.putString(node->getName());
+    out.putVec3f(transform->getCenter());
+    Rotation& rotation = transform->getRotation();
+    out.putVec3f(rotation.getAxis());
+    out.putF32(rotation.getAngle());
+    out.putVec3f(transform->getScale());
+    Rotation& scaleOrientation = transform->getScaleOrientation();
+    out.putVec3f(scaleOrientation.getAxis());
+    out.putF32(scaleOrientation.getAngle());
+    out.putVec3f(transform->getTranslation());
+    out.putVec3f(transform->getBBoxCenter());
+    out.putVec3f(transform->getBBoxSize());
+    saveChildren(out,transform);
+
+  } else if(node->isGroup()) {
+    Group* group = (Group*)node;
+    out.putU32(WrbFormat::NODE_GROUP);
+    out.putString(node->getName());
+    out.putVec3f(group->getBBoxCenter());
+    out.putVec3f(group->getBBoxSize());
+    saveChildren(out,group);
+
+  } else if(node->isShape()) {
+    Shape* shape = (Shape*)node;
+    out.putU32(WrbFormat::NODE_SHAPE);
+    out.putString(node->getName());
+    saveNode(out,shape->getAppearance());
+    Node* geometry = shape->getGeometry();
+    if(geometry!=(Node*)0 &&
+       !geometry->isIndexedFaceSet() && !geometry->isIndexedLineSet())
+      geometry = (Node*)0;
+    saveNode(out,geometry);
+
+  } else if(node->isAppearance()) {
+    Appearance* appearance = (Appearance*)node;
+    out.putU32(WrbFormat::NODE_APPEARANCE);
+    out.putString(node->getName());
+    saveNode(out,appearance->getMaterial());
+    Node* texture = appearance->getTexture();
+    if(texture!=(Node*)0 && !texture->isImageTexture())
+      texture = (Node*)0;
+    saveNode(out,texture);
+
+  } else if(node->isMaterial()) {
+    Material* material = (Material*)node;
+    out.putU32(WrbFormat::NODE_MATERIAL);
+    out.putString(node->getName());
+    out.putF32(material->getAmbientIntensity());
+    out.putColor(material->getDiffuseColor());
+    out.putColor(material->getEmissiveColor());
+    out.putF32(material->getShininess());
+    Color specularColor = material->getSpecularColor();
+    out.putColor(specularColor);
+    out.putF32(material->getTransparency());
+
+  } else if(node->isImageTexture()) {
+    ImageTexture* imageTexture = (ImageTexture*)node;
+    out.putU32(WrbFormat::NODE_IMAGE_TEXTURE);
+    out.putString(node->getName());
+    uint32_t flags = 0;
+    if(imageTexture->getRepeatS()) flags |= WrbFormat::FLAG_REPEAT_S;
+    if(imageTexture->getRepeatT()) flags |= WrbFormat::FLAG_REPEAT_T;
+    out.putU32(flags);
+    vector<string>& url = imageTexture->getUrl();
+    out.putU32((uint32_t)url.size());
+    for(size_t i=0;i<url.size();i++)
+      out.putString(url[i]);
+
+  } else if(node->isIndexedFaceSet()) {
+    IndexedFaceSet& ifs = *((IndexedFaceSet*)node);
+    out.putU32(WrbFormat::NODE_INDEXED_FACE_SET);
+    out.putString(node->getName());
+    uint32_t flags = 0;
+    if(ifs.getCcw())             flags |= WrbFormat::FLAG_CCW;
+    if(ifs.getConvex())          flags |= WrbFormat::FLAG_CONVEX;
+    if(ifs.getSolid())           flags |= WrbFormat::FLAG_SOLID;
+    if(ifs.getNormalPerVertex()) flags |= WrbFormat::FLAG_NORMAL_PER_VERTEX;
+    if(ifs.getColorPerVertex())  flags |= WrbFormat::FLAG_COLOR_PER_VERTEX;
+    out.putU32(flags);
+    out.putF32(ifs.getCreaseangle());
+    out.putArray(ifs.getCoord());
+    out.putArray(ifs.getCoordIndex());
+    out.putArray(ifs.getNormal());
+    out.putArray(ifs.getNormalIndex());
+    out.putArray(ifs.getColor());
+    out.putArray(ifs.getColorIndex());
+    out.putArray(ifs.getTexCoord());
+    out.putArray(ifs.getTexCoordIndex());
+
+  } else if(node->isIndexedLineSet()) {
+    IndexedLineSet& ils = *((IndexedLineSet*)node);
+    out.putU32(WrbFormat::NODE_INDEXED_LINE_SET);
+    out.putString(node->getName());
+    uint32_t flags = 0;
+    if(ils.getColorPerVertex())  flags |= WrbFormat::FLAG_COLOR_PER_VERTEX;
+    out.putU32(flags);
+    out.putArray(ils.getCoord());
+    out.putArray(ils.getCoordIndex());
+    out.putArray(ils.getColor());
+    out.putArray(ils.getColorIndex());
+
+  } else {
+    out.putU32(WrbFormat::NODE_NULL);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+bool SaverWrb::save(const char* filename, SceneGraph& wrl) const {
+  bool success = false;
+  if(filename!=(char*)0) {
+    FILE* fp = fopen(filename,"wb");
+    if(fp!=(FILE*)0) {
+      WrbWriter out(fp);
+
+      // header; the file size is filled in at the end
+      out.put(WrbFormat::magic(),8);
+      out.putU32(WrbFormat::VERSION);
+      out.putU32(WrbFormat::BYTE_ORDER_MARK);
+      out.putU64(0);
+      out.putU64(0);
+
+      saveChildren(out,&wrl);
+
+      uint64_t fileSize = (uint64_t)out.offset();
+      success = out.ok() &&
+        fseek(fp,16,SEEK_SET)==0 && fwrite(&fileSize,8,1,fp)==1;
+      if(fclose(fp)!=0) success = false;
+    }
+  }
+  return success;
+}
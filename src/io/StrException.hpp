@@ -53,7 +53,7 @@ class StrException : public exception {
 
 protected:
 
-  const string& _msg;
+  const string  _msg;
 
 public:
 
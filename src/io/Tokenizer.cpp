@@ -40,10 +40,33 @@
 // DAMAGE.
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
 #include "Tokenizer.hpp"
 #include "StrException.hpp"
+#include "util/ThreadPool.hpp"
 
-Tokenizer::Tokenizer(): _skip(true) {
+#if defined(__has_include)
+#if __has_include(<charconv>) && (__cplusplus>=201703L || (defined(_MSVC_LANG) && _MSVC_LANG>=201703L))
+#include <charconv>
+#endif
+#endif
+
+// floating point from_chars is not available in every standard library
+#if defined(__cpp_lib_to_chars)
+#define TOKENIZER_FROM_CHARS 1
+#endif
+
+static inline bool isBlank(const int c) {
+  return c==' ' || c=='\t' || c=='\n' || c==',' || c=='\015'; // c=="^M"
+}
+
+Tokenizer::Tokenizer():
+  _pos((const char*)0),
+  _end((const char*)0),
+  _read(0),
+  _skip(true) {
 }
 
 void Tokenizer::setSkipComments(const bool value) {
@@ -51,27 +74,32 @@ void Tokenizer::setSkipComments(const bool value) {
 }
 
 bool Tokenizer::get() {
-  char c='\0';
+  int c = EOF;
   do {
     clear();
     // skip blank space
-    while((c=getc())!=EOF)
-      if(!(c==' ' || c=='\t' || c=='\n' || c==',' || c=='\015'))
-        { push_back(c); break; }
-    // collect token characters
-    while(((c=getc())!=EOF) &&
-          !(c==' ' || c=='\t' || c=='\n' || c==',' || c=='\015')) // c=="^M"
-      push_back(c);
+    while((c=getc())!=EOF && isBlank(c));
+    if(c==EOF) break;
+    push_back((char)c);
+    // collect token characters, a block at a time
+    c = EOF;
+    while(_pos<_end || fill()) {
+      const char* p = _pos;
+      while(p<_end && !isBlank((unsigned char)*p)) p++;
+      append(_pos,p-_pos);
+      _pos = p;
+      // consume the blank space character which ends the token
+      if(p<_end) { c = (unsigned char)*_pos++; break; }
+    }
     // if comment, get the rest of the line, including blank spaces
-    if(size()>0 && (*this)[0]=='#') {
+    if((*this)[0]=='#') {
       // last blank space character read is not in tkn yet
+      if(c!='\n' && c!=EOF)
+        push_back((char)c);
       if(c!='\n')
-        push_back(c);
-      while((c=getc())!=EOF && c!='\n')
-        push_back(c);
+        while((c=getc())!=EOF && c!='\n')
+          push_back((char)c);
     }
-    // terminate the string
-    // push_back('\0');
   } while(_skip && length()>0 && *(begin())=='#');
   
   return (length()>0)?true:false;
@@ -83,15 +111,15 @@ void Tokenizer::get(const string& errMsg) /* throw(StrException *) */ {
 
 bool Tokenizer::getline() {
   clear();
-  char c='\0';
+  int c = EOF;
   while((c=getc())!=EOF && c!='\n') {
-    push_back(c);
+    push_back((char)c);
   }
   return (length()>0)?true:false;
 }
 
 void Tokenizer::nextline() {
-  char c='\0';
+  int c = EOF;
   while((c=getc())!=EOF && c!='\n');
 }
 
@@ -111,54 +139,264 @@ bool Tokenizer::getBool(bool& b) {
   return success;
 }
 
+// conversion of the characters in [first,last); as with sscanf, a
+// valid prefix is enough
+
+#ifndef TOKENIZER_FROM_CHARS
+// strtol and strtof need a NUL terminated string
+class TokenizerCStr {
+public:
+  TokenizerCStr(const char* first, const char* last) {
+    size_t n = (size_t)(last-first);
+    if(n<sizeof(_buf)) {
+      memcpy(_buf,first,n); _buf[n] = '\0'; _str = _buf;
+    } else {
+      _long.assign(first,n); _str = _long.c_str();
+    }
+  }
+  const char* c_str() const { return _str; }
+private:
+  char        _buf[64];
+  string      _long;
+  const char* _str;
+};
+#endif
+
+static bool parseInt(const char* first, const char* last, int& i) {
+  if(first<last && *first=='+') first++;
+#ifdef TOKENIZER_FROM_CHARS
+  std::from_chars_result r = std::from_chars(first,last,i);
+  return r.ptr!=first && r.ec==std::errc();
+#else
+  TokenizerCStr str(first,last);
+  char* p = (char*)0;
+  errno = 0;
+  long value = strtol(str.c_str(),&p,10);
+  if(p==str.c_str() || errno!=0 || value<-2147483647L-1L || value>2147483647L) return false;
+  i = (int)value;
+  return true;
+#endif
+}
+
+static bool parseUInt(const char* first, const char* last, unsigned int& ui) {
+  if(first<last && *first=='+') first++;
+#ifdef TOKENIZER_FROM_CHARS
+  std::from_chars_result r = std::from_chars(first,last,ui);
+  return r.ptr!=first && r.ec==std::errc();
+#else
+  if(first<last && *first=='-') return false;
+  TokenizerCStr str(first,last);
+  char* p = (char*)0;
+  errno = 0;
+  unsigned long value = strtoul(str.c_str(),&p,10);
+  if(p==str.c_str() || errno!=0 || value>4294967295UL) return false;
+  ui = (unsigned int)value;
+  return true;
+#endif
+}
+
+static bool parseFloat(const char* first, const char* last, float& f) {
+  if(first<last && *first=='+') first++;
+#ifdef TOKENIZER_FROM_CHARS
+  std::from_chars_result r = std::from_chars(first,last,f);
+  if(r.ptr!=first && r.ec==std::errc()) return true;
+  // out of range values, such as denormals, are handled by strtof
+  string str(first,last);
+#else
+  TokenizerCStr str(first,last);
+#endif
+  char* p = (char*)0;
+  float value = strtof(str.c_str(),&p);
+  if(p==str.c_str()) return false;
+  f = value;
+  return true;
+}
+
+static inline bool parseValue(const char* first, const char* last, float& value) {
+  return parseFloat(first,last,value);
+}
+
+static inline bool parseValue(const char* first, const char* last, int& value) {
+  return parseInt(first,last,value);
+}
+
+bool Tokenizer::toInt(int& i) const {
+  return parseInt(data(),data()+length(),i);
+}
+
+bool Tokenizer::toUInt(unsigned int& ui) const {
+  return parseUInt(data(),data()+length(),ui);
+}
+
+bool Tokenizer::toFloat(float& f) const {
+  return parseFloat(data(),data()+length(),f);
+}
+
+// arrays which are entirely in the current block, and larger than
+// this, are split into chunks of at least the following size, which
+// are parsed in parallel
+#define TOKENIZER_PARALLEL_MIN_BYTES (1<<20)
+#define TOKENIZER_PARALLEL_CHUNK     (1<<16)
+
+static inline bool isValueEnd(const char c) {
+  return isBlank((unsigned char)c) || c==']' || c=='#';
+}
+
+// parse all the values in [first,last), which contains no comments
+template<class T>
+static bool scanValues(const char* first, const char* last, vector<T>& vec) {
+  T value;
+  vec.reserve((size_t)(last-first)/8);
+  const char* p = first;
+  while(true) {
+    while(p<last && isBlank((unsigned char)*p)) p++;
+    if(p==last) return true;
+    const char* q = p;
+    while(q<last && !isValueEnd(*q)) q++;
+    if(!parseValue(p,q,value)) return false;
+    vec.push_back(value);
+    p = q;
+  }
+}
+
+// Returns -1 if the array does not qualify for parallel parsing, and
+// otherwise true or false, as getVec().
+template<class T>
+int Tokenizer::getVecParallel(vector<T>& vec) {
+  size_t size = (size_t)(_end-_pos);
+  if(size<TOKENIZER_PARALLEL_MIN_BYTES) return -1;
+  const char* close = (const char*)memchr(_pos,']',size);
+  if(close==(const char*)0) return -1;
+  size = (size_t)(close-_pos);
+  if(size<TOKENIZER_PARALLEL_MIN_BYTES) return -1;
+  // a comment could hide a "]"
+  if(memchr(_pos,'#',size)!=(const void*)0) return -1;
+
+  ThreadPool& pool = ThreadPool::getInstance();
+  size_t nChunks = (size_t)(4*pool.getNumberOfThreads());
+  if(nChunks>size/TOKENIZER_PARALLEL_CHUNK) nChunks = size/TOKENIZER_PARALLEL_CHUNK;
+  if(nChunks<2) return -1;
+
+  // chunk boundaries, moved forward to blank space
+  vector<const char*> bound(nChunks+1);
+  bound[0]       = _pos;
+  bound[nChunks] = close;
+  for(size_t k=1;k<nChunks;k++) {
+    const char* p = _pos+k*(size/nChunks);
+    if(p<bound[k-1]) p = bound[k-1];
+    while(p<close && !isBlank((unsigned char)*p)) p++;
+    bound[k] = p;
+  }
+
+  vector< vector<T> > part(nChunks);
+  vector<char>        ok(nChunks,0);
+  pool.run((int)nChunks,[&](int k) {
+      ok[k] = scanValues(bound[k],bound[k+1],part[k])?1:0;
+    });
+  for(size_t k=0;k<nChunks;k++)
+    if(ok[k]==0) return 0;
+
+  // concatenate the chunks
+  vector<size_t> offset(nChunks+1);
+  offset[0] = vec.size();
+  for(size_t k=0;k<nChunks;k++)
+    offset[k+1] = offset[k]+part[k].size();
+  vec.resize(offset[nChunks]);
+  pool.run((int)nChunks,[&](int k) {
+      if(part[k].size()>0)
+        memcpy(&vec[offset[k]],part[k].data(),part[k].size()*sizeof(T));
+      vector<T>().swap(part[k]);
+    });
+
+  _pos = close+1;
+  return 1;
+}
+
+// Array values are parsed in place within the current block; only the
+// values which straddle two blocks are assembled in the token string.
+// When the vector is full, its capacity is at least doubled, starting
+// from a large minimum, so that big arrays are reallocated only a few
+// times.
+template<class T>
+bool Tokenizer::getVec(vector<T>& vec) {
+  int parallel = getVecParallel(vec);
+  if(parallel>=0) return parallel==1;
+  T value;
+  while(true) {
+    // skip blank space and comments
+    if(_pos>=_end && !fill()) return false;
+    char c = *_pos;
+    if(isBlank((unsigned char)c)) {
+      _pos++;
+    } else if(c=='#') {
+      nextline();
+    } else if(c==']') {
+      _pos++;
+      return true;
+    } else {
+      // value token extent
+      const char* p = _pos;
+      while(p<_end && !isValueEnd(*p)) p++;
+      bool ok;
+      if(p<_end) {
+        ok = parseValue(_pos,p,value);
+        _pos = p;
+      } else {
+        // the value continues in the next block
+        clear();
+        append(_pos,p-_pos);
+        _pos = p;
+        while(fill()) {
+          p = _pos;
+          while(p<_end && !isValueEnd(*p)) p++;
+          append(_pos,p-_pos);
+          _pos = p;
+          if(p<_end) break;
+        }
+        ok = parseValue(data(),data()+length(),value);
+      }
+      if(!ok) return false;
+      if(vec.size()==vec.capacity())
+        vec.reserve((vec.capacity()<4096)?4096:2*vec.capacity());
+      vec.push_back(value);
+    }
+  }
+}
+
+bool Tokenizer::getVecFloat(vector<float>& vec) {
+  return getVec(vec);
+}
+
+bool Tokenizer::getVecInt(vector<int>& vec) {
+  return getVec(vec);
+}
+
 bool Tokenizer::getInt(int& i) {
-  bool success =
-    (get() && (sscanf(&((*this)[0]),"%d",&i)==1));
-  return success;
+  return get() && toInt(i);
 }
 
 bool Tokenizer::getUInt(unsigned int& ui) {
-  bool success =
-    (get() && (sscanf(&((*this)[0]),"%u",&ui)==1));
-  return success;
+  return get() && toUInt(ui);
 }
 
 bool Tokenizer::getFloat(float& f) {
-  bool success =
-    (get() && (sscanf(&((*this)[0]),"%f",&f)==1));
-  return success;
+  return get() && toFloat(f);
 }
 
 bool Tokenizer::getColor(Color& c) {
-  bool success =
-    (get() && (sscanf(&((*this)[0]),"%f",&(c.r))==1)) &&
-    (get() && (sscanf(&((*this)[0]),"%f",&(c.g))==1)) &&
-    (get() && (sscanf(&((*this)[0]),"%f",&(c.b))==1));
-  return success;
+  return getFloat(c.r) && getFloat(c.g) && getFloat(c.b);
 }
 
 bool Tokenizer::getVec4f(Vec4f& v) {
-  bool success =
-    (get() && (sscanf(&((*this)[0]),"%f",&(v.x))==1)) &&
-    (get() && (sscanf(&((*this)[0]),"%f",&(v.y))==1)) &&
-    (get() && (sscanf(&((*this)[0]),"%f",&(v.z))==1)) &&
-    (get() && (sscanf(&((*this)[0]),"%f",&(v.w))==1));
-  return success;
+  return getFloat(v.x) && getFloat(v.y) && getFloat(v.z) && getFloat(v.w);
 }
 
 bool Tokenizer::getVec3f(Vec3f& v) {
-  bool success =
-    (get() && (sscanf(&((*this)[0]),"%f",&(v.x))==1)) &&
-    (get() && (sscanf(&((*this)[0]),"%f",&(v.y))==1)) &&
-    (get() && (sscanf(&((*this)[0]),"%f",&(v.z))==1));
-  return success;
+  return getFloat(v.x) && getFloat(v.y) && getFloat(v.z);
 }
 
 bool Tokenizer::getVec2f(Vec2f& v) {
-  bool success =
-    (get() && (sscanf(&((*this)[0]),"%f",&(v.x))==1)) &&
-    (get() && (sscanf(&((*this)[0]),"%f",&(v.y))==1));
-  return success;
+  return getFloat(v.x) && getFloat(v.y);
 }
 
 bool Tokenizer::equals(const char* str) {
@@ -42,21 +42,44 @@
 #ifndef TOKENIZER_HPP
 #define TOKENIZER_HPP
 
+#include <vector>
 #include <wrl/Node.hpp>
 
 // abstract class
 // use TokenizerFile or TokenizerString instead
+//
+// The input is consumed in blocks: the derived classes only implement
+// fill(), which points _pos and _end to the next block of characters
+// and adds its length to _read, and the characters are then read
+// without virtual calls. Numbers are converted with std::from_chars
+// when the standard library supports it, and with strtof/strtol
+// otherwise.
 class Tokenizer : public string {
 
+protected:
+
+  const char* _pos; // next character of the current block
+  const char* _end; // end of the current block
+  size_t      _read; // characters in the blocks filled so far
+
+  // returns false at the end of the input
+  virtual bool fill() = 0;
+
 private:
 
   bool _skip;
 
-  virtual char getc() = 0;
+  inline int getc() {
+    return (_pos<_end || fill())?(int)(unsigned char)(*_pos++):EOF;
+  }
+
+  template<class T> bool getVec(vector<T>& vec);
+  template<class T> int  getVecParallel(vector<T>& vec);
 
 public:
 
   Tokenizer();
+  virtual ~Tokenizer() {}
 
   bool get();
   void get(const string& errMsg);
@@ -75,6 +98,25 @@ public:
   bool expecting(const char* str);
   void setSkipComments(const bool value);
 
+  // number of characters consumed so far
+  size_t getPosition() const { return _read-(size_t)(_end-_pos); }
+
+  // convert the current token, without reading a new one
+  bool toInt(int& i) const;
+  bool toUInt(unsigned int& ui) const;
+  bool toFloat(float& f) const;
+
+  // Bulk readers for the values of a numeric array, to be called after
+  // the opening "[" has been read. The values are appended to vec
+  // directly from the input buffer, without building a token for each
+  // value, up to and including the closing "]", which may follow the
+  // last value without blank space. Return false if a value cannot be
+  // parsed, or if the input ends before "]". Large arrays which are
+  // entirely within the current block are split at blank space into
+  // chunks, which are parsed in parallel on the shared ThreadPool.
+  bool getVecFloat(vector<float>& vec);
+  bool getVecInt(vector<int>& vec);
+
 };
 
 #endif // TOKENIZER_HPP
@@ -42,13 +42,26 @@
 #include <stdio.h>
 #include "TokenizerFile.hpp"
 
+#define TOKENIZER_FILE_BLOCK_SIZE (1<<16)
+
 TokenizerFile::TokenizerFile(FILE* fp):
   Tokenizer(),
-  _fp(fp) {
+  _fp(fp),
+  _block(new char[TOKENIZER_FILE_BLOCK_SIZE]) {
+}
+
+TokenizerFile::~TokenizerFile() {
+  delete [] _block;
 }
 
-char TokenizerFile::getc() {
-  return static_cast<char>(std::getc(_fp)); // c library function
+bool TokenizerFile::fill() {
+  size_t n = 0;
+  if(_fp!=(FILE*)0)
+    n = fread(_block,1,TOKENIZER_FILE_BLOCK_SIZE,_fp);
+  _pos = _block;
+  _end = _block+n;
+  _read += n;
+  return n>0;
 }
 
 // #define LINE_BUFFER_LENGTH 1024
@@ -48,16 +48,23 @@ class TokenizerFile : public Tokenizer {
 
 protected:
 
-  FILE* _fp;
-  bool  _skip; // if(_skip) skip comments
+  FILE*  _fp;
+  char*  _block;
 
 private:
 
-  virtual char getc();
+  virtual bool fill();
+
+  // not copyable
+  TokenizerFile(const TokenizerFile&);
+  TokenizerFile& operator=(const TokenizerFile&);
 
 public:
 
+  // the characters are read from fp with fread in large blocks, so
+  // fp should not be read by other means while the tokenizer is in use
   TokenizerFile(FILE* fp);
+  ~TokenizerFile();
 
   // bool getline();
 
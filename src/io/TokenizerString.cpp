@@ -45,12 +45,14 @@
 TokenizerString::TokenizerString(const string& str):
   Tokenizer(),
   _str(str), // save a copy of str
-  _pos(0) {
+  _filled(false) {
 }
 
-char TokenizerString::getc() {
-  if(_pos<_str.length())
-    return _str[_pos++];
-  else
-    return EOF;
+bool TokenizerString::fill() {
+  if(_filled) return false;
+  _filled = true;
+  _pos = _str.data();
+  _end = _pos+_str.length();
+  _read += _str.length();
+  return _pos<_end;
 }
@@ -49,9 +49,10 @@ class TokenizerString : public Tokenizer {
 private:
 
   const string  _str;
-  size_t        _pos;
+  bool          _filled;
 
-  virtual char getc();
+  // the whole string is a single block
+  virtual bool fill();
 
 public:
 
@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// WrbFormat.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _WRB_FORMAT_HPP_
+#define _WRB_FORMAT_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Layout of the .wrb binary scene graph files, shared by LoaderWrb and
+// SaverWrb. All values are stored in the byte order of the machine
+// which wrote the file; the header contains a byte order mark, and the
+// loader rejects files written with the opposite byte order.
+//
+// header (32 bytes)
+//   char     magic[8]      "#WRB\0\0\0\0"
+//   uint32   version
+//   uint32   byteOrder     0x01020304
+//   uint64   fileSize
+//   uint64   reserved
+// scene graph
+//   uint32   nChildren, followed by nChildren nodes
+//
+// Every node starts with a uint32 tag and a string with the DEF name.
+// A string is a uint32 length followed by the characters. A numeric
+// array is a uint64 number of values, followed by the values, which
+// start at a file offset multiple of 16 bytes, so that they are
+// aligned in memory when the file is memory mapped. Boolean fields
+// are packed into uint32 flag words. The node fields follow the order
+// in which they are declared in the corresponding VRML nodes; see
+// SaverWrb.cpp for the details.
+
+class WrbFormat {
+
+public:
+
+  enum Tag {
+    NODE_NULL = 0,
+    NODE_GROUP,
+    NODE_TRANSFORM,
+    NODE_SHAPE,
+    NODE_APPEARANCE,
+    NODE_MATERIAL,
+    NODE_IMAGE_TEXTURE,
+    NODE_INDEXED_FACE_SET,
+    NODE_INDEXED_LINE_SET
+  };
+
+  // IndexedFaceSet and IndexedLineSet flags
+  enum Flag {
+    FLAG_CCW               = 1<<0,
+    FLAG_CONVEX            = 1<<1,
+    FLAG_SOLID             = 1<<2,
+    FLAG_NORMAL_PER_VERTEX = 1<<3,
+    FLAG_COLOR_PER_VERTEX  = 1<<4,
+    FLAG_REPEAT_S          = 1<<5,
+    FLAG_REPEAT_T          = 1<<6
+  };
+
+  static const uint32_t VERSION         = 1;
+  static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+  static const size_t   HEADER_SIZE     = 32;
+  static const size_t   ALIGNMENT       = 16;
+
+  static const char*    magic() { return "#WRB\0\0\0\0"; }
+
+};
+
+#endif /* _WRB_FORMAT_HPP_ */
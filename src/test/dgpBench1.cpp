@@ -0,0 +1,235 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// dgpBench1.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <stdio.h>
+#include <string>
+#include <iostream>
+#include <chrono>
+
+using namespace std;
+
+#include <wrl/SceneGraph.hpp>
+#include <io/TokenizerFile.hpp>
+#include <io/LoaderWrl.hpp>
+
+// Measures the throughput of the ascii parsing path used by the
+// loaders. The "getc+sscanf" pass reproduces the original Tokenizer,
+// which read one character at a time through a virtual getc() call
+// and converted numbers with sscanf; the "TokenizerFile" pass uses the
+// current block buffered Tokenizer.
+
+class Data {
+public:
+  bool   _debug;
+  int    _repeat;
+  string _inFile;
+public:
+  Data():
+    _debug(false),
+    _repeat(3),
+    _inFile("")
+  { }
+};
+
+const char* tv(bool value)        { return (value)?"true":"false";                 }
+
+void options(Data& D) {
+  cerr << "   -d|-debug               [" << tv(D._debug)          << "]" << endl;
+  cerr << "   -r|-repeat n            [" << D._repeat             << "]" << endl;
+}
+
+void usage(Data& D) {
+  cerr << "USAGE: dgpBench1 [options] inFile" << endl;
+  cerr << "   -h|-help" << endl;
+  options(D);
+  cerr << endl;
+  exit(0);
+}
+
+void error(const char *msg) {
+  cerr << "ERROR: dgpBench1 | " << ((msg)?msg:"") << endl;
+  exit(0);
+}
+
+//////////////////////////////////////////////////////////////////////
+// original character at a time tokenizer
+
+class TokenizerGetc : public string {
+private:
+  FILE* _fp;
+  virtual char getc() { return static_cast<char>(std::getc(_fp)); }
+public:
+  TokenizerGetc(FILE* fp):_fp(fp) { }
+  virtual ~TokenizerGetc() { }
+  bool get() {
+    char c='\0';
+    do {
+      clear();
+      while((c=getc())!=EOF)
+        if(!(c==' ' || c=='\t' || c=='\n' || c==',' || c=='\015'))
+          { push_back(c); break; }
+      while(((c=getc())!=EOF) &&
+            !(c==' ' || c=='\t' || c=='\n' || c==',' || c=='\015'))
+        push_back(c);
+      if(size()>0 && (*this)[0]=='#') {
+        if(c!='\n')
+          push_back(c);
+        while((c=getc())!=EOF && c!='\n')
+          push_back(c);
+      }
+    } while(length()>0 && *(begin())=='#');
+    return (length()>0)?true:false;
+  }
+};
+
+//////////////////////////////////////////////////////////////////////
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds(const Clock::time_point& t0) {
+  return std::chrono::duration<double>(Clock::now()-t0).count();
+}
+
+long fileSize(const char* filename) {
+  FILE* fp = fopen(filename,"rb");
+  if(fp==(FILE*)0) return -1;
+  fseek(fp,0,SEEK_END);
+  long size = ftell(fp);
+  fclose(fp);
+  return size;
+}
+
+// returns the number of tokens which are numbers
+long benchGetc(const char* filename) {
+  long  nNumbers = 0;
+  float value;
+  FILE* fp = fopen(filename,"r");
+  if(fp==(FILE*)0) return -1;
+  TokenizerGetc tkn(fp);
+  while(tkn.get())
+    if(sscanf(tkn.c_str(),"%f",&value)==1)
+      nNumbers++;
+  fclose(fp);
+  return nNumbers;
+}
+
+long benchTokenizer(const char* filename) {
+  long  nNumbers = 0;
+  float value;
+  FILE* fp = fopen(filename,"r");
+  if(fp==(FILE*)0) return -1;
+  TokenizerFile tkn(fp);
+  while(tkn.get())
+    if(tkn.toFloat(value))
+      nNumbers++;
+  fclose(fp);
+  return nNumbers;
+}
+
+bool benchLoaderWrl(const char* filename) {
+  SceneGraph wrl;
+  LoaderWrl  loader;
+  return loader.load(filename,wrl);
+}
+
+void report(const char* name, const double mb, const double t, const long n) {
+  fprintf(stderr,"  %-16s %8.3f s %10.2f MB/s  numbers=%ld\n",
+          name,t,(t>0.0)?mb/t:0.0,n);
+}
+
+int main(int argc, char **argv) {
+
+  Data D;
+
+  if(argc==1) usage(D);
+  for(int i=1;i<argc;i++) {
+    if(string(argv[i])=="-h" || string(argv[i])=="-help") {
+      usage(D);
+    } else if(string(argv[i])=="-d" || string(argv[i])=="-debug") {
+      D._debug = !D._debug;
+    } else if(string(argv[i])=="-r" || string(argv[i])=="-repeat") {
+      if(++i>=argc) error("missing repeat value");
+      D._repeat = atoi(argv[i]);
+      if(D._repeat<1) D._repeat = 1;
+    } else if(string(argv[i])[0]=='-') {
+      error("unknown option");
+    } else if(D._inFile=="") {
+      D._inFile = string(argv[i]);
+    }
+  }
+
+  if(D._inFile=="") error("no inFile");
+
+  const char* filename = D._inFile.c_str();
+  long size = fileSize(filename);
+  if(size<0) error("cannot open inFile");
+  double mb = (double)size/(1024.0*1024.0);
+
+  fprintf(stderr,"dgpBench1 {\n");
+  fprintf(stderr,"  inFile = %s (%.2f MB)\n",filename,mb);
+
+  // report the best of D._repeat runs
+  double tGetc = -1.0, tTkn = -1.0, tWrl = -1.0, t;
+  long   nGetc = 0, nTkn = 0;
+  bool   isWrl = (D._inFile.size()>4 &&
+                  D._inFile.compare(D._inFile.size()-4,4,".wrl")==0);
+  for(int r=0;r<D._repeat;r++) {
+    Clock::time_point t0 = Clock::now();
+    nGetc = benchGetc(filename);
+    t = seconds(t0);
+    if(tGetc<0.0 || t<tGetc) tGetc = t;
+
+    t0 = Clock::now();
+    nTkn = benchTokenizer(filename);
+    t = seconds(t0);
+    if(tTkn<0.0 || t<tTkn) tTkn = t;
+
+    if(isWrl) {
+      t0 = Clock::now();
+      if(benchLoaderWrl(filename)==false) error("LoaderWrl failed");
+      t = seconds(t0);
+      if(tWrl<0.0 || t<tWrl) tWrl = t;
+    }
+    if(D._debug) fprintf(stderr,"  run %d done\n",r);
+  }
+
+  report("getc+sscanf",mb,tGetc,nGetc);
+  report("TokenizerFile",mb,tTkn,nTkn);
+  if(isWrl) report("LoaderWrl",mb,tWrl,nTkn);
+  if(nGetc!=nTkn)
+    fprintf(stderr,"  WARNING : different number counts\n");
+  fprintf(stderr,"}\n");
+
+  return 0;
+}
@@ -34,25 +34,40 @@
 
 #include <string>
 #include <iostream>
+#include <math.h>
 
 using namespace std;
 
 #include <wrl/SceneGraph.hpp>
+#include <wrl/SceneGraphProcessor.hpp>
+#include <wrl/SceneGraphTraversal.hpp>
 #include <io/AppLoader.hpp>
 #include <io/AppSaver.hpp>
 #include <io/LoaderStl.hpp>
 #include <io/LoaderWrl.hpp>
+#include <io/LoaderWrb.hpp>
 #include <io/SaverWrl.hpp>
+#include <io/SaverWrb.hpp>
 #include <io/SaverStl.hpp>
 
 class Data {
 public:
   bool   _debug;
+  bool   _weld;
+  float  _epsilon;
+  bool   _binary;
+  int    _update;
+  string _cacheDir;
   string _inFile;
   string _outFile;
 public:
   Data():
     _debug(false),
+    _weld(false),
+    _epsilon(0.0f),
+    _binary(false),
+    _update(0),
+    _cacheDir(""),
     _inFile(""),
     _outFile("")
   { }
@@ -62,6 +77,11 @@ const char* tv(bool value)        { return (value)?"true":"false";
 
 void options(Data& D) {
   cerr << "   -d|-debug               [" << tv(D._debug)          << "]" << endl;
+  cerr << "   -w|-weld                [" << tv(D._weld)           << "]" << endl;
+  cerr << "   -e|-epsilon value       [" << D._epsilon            << "]" << endl;
+  cerr << "   -b|-binary              [" << tv(D._binary)         << "]" << endl;
+  cerr << "   -c|-cache dir           [" << D._cacheDir           << "]" << endl;
+  cerr << "   -u|-update nVertices    [" << D._update             << "]" << endl;
 }
 
 void usage(Data& D) {
@@ -77,6 +97,116 @@ void error(const char *msg) {
   exit(0);
 }
 
+//////////////////////////////////////////////////////////////////////
+// Checks the incremental update of per-vertex normals against a full
+// recomputation, for every weighting: the normals computed with the
+// area weighting are first requested with another one, and then nMove
+// scattered vertices are moved, and recorded one at a time as changed,
+// so that the change ranges collapse when there are many. The
+// coordinates and normals are restored afterwards.
+
+void getIndexedFaceSets(SceneGraph& wrl, vector<IndexedFaceSet*>& ifsList) {
+  SceneGraphTraversal traversal(wrl);
+  traversal.start();
+  Node* node;
+  while((node=traversal.next())!=(Node*)0) {
+    if(node->isShape()) {
+      node = ((Shape*)node)->getGeometry();
+      if(node!=(Node*)0 && node->isIndexedFaceSet())
+        ifsList.push_back((IndexedFaceSet*)node);
+    }
+  }
+}
+
+float maxNormalDifference(vector<IndexedFaceSet*>& ifsList,
+                          vector< vector<float> >& normal) {
+  float dMax = 0.0f;
+  for(size_t k=0;k<ifsList.size();k++) {
+    vector<float>& n = ifsList[k]->getNormal();
+    if(n.size()!=normal[k].size()) return INFINITY;
+    for(size_t i=0;i<n.size();i++) {
+      float d = fabs(n[i]-normal[k][i]);
+      if(d>dMax) dMax = d;
+    }
+  }
+  return dMax;
+}
+
+bool checkNormalUpdate(SceneGraph& wrl, const int nMove, const bool debug) {
+  const char* name[3] = { "area", "angle", "edge" };
+  const float tolerance = 1.0e-5f;
+  bool success = true;
+
+  vector<IndexedFaceSet*> ifsList;
+  getIndexedFaceSets(wrl,ifsList);
+  vector< vector<float> > coord(ifsList.size());
+  vector< vector<float> > normal(ifsList.size());
+  vector< vector<int> >   normalIndex(ifsList.size());
+  for(size_t k=0;k<ifsList.size();k++) {
+    coord[k]       = ifsList[k]->getCoord();
+    normal[k]      = ifsList[k]->getNormal();
+    normalIndex[k] = ifsList[k]->getNormalIndex();
+  }
+
+  SceneGraphProcessor processor(wrl);
+  vector< vector<float> > incremental(ifsList.size());
+  for(int w=0;w<3;w++) {
+    SceneGraphProcessor::NormalWeight weight =
+      (SceneGraphProcessor::NormalWeight)w;
+
+    // another weighting, without changes
+    processor.normalClear();
+    processor.computeNormalPerVertex(SceneGraphProcessor::NORMAL_WEIGHT_AREA);
+    processor.computeNormalPerVertex(weight);
+    for(size_t k=0;k<ifsList.size();k++)
+      incremental[k] = ifsList[k]->getNormal();
+    processor.normalClear();
+    processor.computeNormalPerVertex(weight);
+    float dWeight = maxNormalDifference(ifsList,incremental);
+
+    // move every step-th vertex, recording each one as a range
+    for(size_t k=0;k<ifsList.size();k++) {
+      IndexedFaceSet& ifs = *ifsList[k];
+      vector<float>& x = ifs.getCoord();
+      int nV   = (int)(x.size()/3);
+      int step = (nMove>0 && nV>nMove)?nV/nMove:1;
+      for(int iV=0;iV<nV && iV/step<nMove;iV+=step) {
+        x[3*iV  ] += 0.01f*(float)cos((double)iV);
+        x[3*iV+1] += 0.01f*(float)sin((double)iV);
+        ifs.setChanged(IndexedFaceSet::CHANGED_COORD,iV,iV+1);
+      }
+    }
+    processor.computeNormalPerVertex(weight);
+    for(size_t k=0;k<ifsList.size();k++)
+      incremental[k] = ifsList[k]->getNormal();
+    processor.normalClear();
+    processor.computeNormalPerVertex(weight);
+    float dUpdate = maxNormalDifference(ifsList,incremental);
+
+    if(debug)
+      cerr << "    " << name[w]
+           << " weight change " << dWeight
+           << " update " << dUpdate << endl;
+    if(dWeight>tolerance || dUpdate>tolerance) success = false;
+
+    for(size_t k=0;k<ifsList.size();k++) {
+      ifsList[k]->getCoord() = coord[k];
+      ifsList[k]->clearChanged();
+    }
+  }
+
+  for(size_t k=0;k<ifsList.size();k++) {
+    IndexedFaceSet& ifs = *ifsList[k];
+    ifs.getNormal()      = normal[k];
+    ifs.getNormalIndex() = normalIndex[k];
+    ifs.setNormalWeight(-1);
+    ifs.setChanged(IndexedFaceSet::CHANGED_COORD);
+    ifs.setChanged(IndexedFaceSet::CHANGED_NORMAL);
+    ifs.clearChanged(IndexedFaceSet::STALE_NORMAL);
+  }
+  return success;
+}
+
 //////////////////////////////////////////////////////////////////////
 int main(int argc, char **argv) {
 
@@ -89,6 +219,19 @@ int main(int argc, char **argv) {
       usage(D);
     } else if(string(argv[i])=="-d" || string(argv[i])=="-debug") {
       D._debug = !D._debug;
+    } else if(string(argv[i])=="-w" || string(argv[i])=="-weld") {
+      D._weld = !D._weld;
+    } else if(string(argv[i])=="-e" || string(argv[i])=="-epsilon") {
+      if(++i>=argc) error("missing epsilon value");
+      D._epsilon = (float)atof(argv[i]);
+    } else if(string(argv[i])=="-b" || string(argv[i])=="-binary") {
+      D._binary = !D._binary;
+    } else if(string(argv[i])=="-c" || string(argv[i])=="-cache") {
+      if(++i>=argc) error("missing cache directory");
+      D._cacheDir = string(argv[i]);
+    } else if(string(argv[i])=="-u" || string(argv[i])=="-update") {
+      if(++i>=argc) error("missing number of vertices");
+      D._update = atoi(argv[i]);
     } else if(string(argv[i])[0]=='-') {
       error("unknown option");
     } else if(D._inFile=="") {
@@ -121,17 +264,23 @@ int main(int argc, char **argv) {
   // create loader and saver factories /////////////////////////////////
   AppLoader loaderFactory;
   AppSaver  saverFactory;
+  loaderFactory.setCacheDirectory(D._cacheDir);
 
   // register input file loaders
   LoaderWrl* wrlLoader = new LoaderWrl();
   loaderFactory.registerLoader(wrlLoader);
+  LoaderWrb* wrbLoader = new LoaderWrb();
+  loaderFactory.registerLoader(wrbLoader);
   LoaderStl* stlLoader = new LoaderStl();
   loaderFactory.registerLoader(stlLoader);
 
   // register output file savers  
   SaverWrl* wrlSaver = new SaverWrl();
   saverFactory.registerSaver(wrlSaver);
+  SaverWrb* wrbSaver = new SaverWrb();
+  saverFactory.registerSaver(wrbSaver);
   SaverStl* stlSaver = new SaverStl();
+  stlSaver->setBinary(D._binary);
   saverFactory.registerSaver(stlSaver);
 
   // read input file and create SceneGraph /////////////////////////////
@@ -146,6 +295,7 @@ int main(int argc, char **argv) {
 
   if(D._debug) {
     cerr << "    success        = " << tv(success)          << endl;
+    cerr << "    fromCache      = " << tv(loaderFactory.loadedFromCache()) << endl;
     cerr << "  }" << endl;
     cerr << endl;
   }
@@ -154,9 +304,26 @@ int main(int argc, char **argv) {
 
   // process ///////////////////////////////////////////////////////////
   
-  // if(D._debug) cerr << "  processing {" << endl;
-  // if(D._debug) cerr << "    nothing to do in this assignment" << endl;
-  // if(D._debug) cerr << "  }" << endl;  
+  if(D._weld) {
+    if(D._debug) cerr << "  processing {" << endl;
+    if(D._debug) cerr << "    weldVertices(" << D._epsilon << ")" << endl;
+    SceneGraphProcessor processor(wrl);
+    processor.weldVertices(D._epsilon);
+    if(D._debug) cerr << "  }" << endl;
+    if(D._debug) cerr << endl;
+  }
+
+  if(D._update>0) {
+    if(D._debug) cerr << "  checkNormalUpdate(" << D._update << ") {" << endl;
+    bool updated = checkNormalUpdate(wrl,D._update,D._debug);
+    if(D._debug) cerr << "    success        = " << tv(updated) << endl;
+    if(D._debug) cerr << "  }" << endl;
+    if(D._debug) cerr << endl;
+    if(updated==false) {
+      cerr << "ERROR: dgpTest1 | incremental normal update mismatch" << endl;
+      return -1;
+    }
+  }
 
   // write output file /////////////////////////////////////////////////
   
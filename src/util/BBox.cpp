@@ -34,6 +34,7 @@
 
 #include <math.h>
 #include "BBox.hpp"
+#include "MinMax.hpp"
 
 BBox::~BBox() {
   if(_min   !=(float*)0) delete [] _min;
@@ -47,20 +48,10 @@ BBox::BBox(const int d, const vector<float>& v, const bool cube):
     _min    = new float[d];
     _max    = new float[d];
     float* center = new float[d];
-    int i,j;
+    int i;
     int nV = (int)(v.size()/d);
     if(nV>0) {
-      for(i=0;i<d;i++) {
-        float vji = v[i];
-        _min[i]    = vji;
-        _max[i]    = vji;
-      }
-      for(j=1;j<nV;j++)
-        for(i=0;i<d;i++) {
-          float vji = v[d*j+i];
-          if(vji<_min[i]) _min[i] = vji;
-          if(vji>_max[i]) _max[i] = vji;
-        }
+      MinMax::compute(v.data(),nV,d,_min,_max);
       for(i=0;i<d;i++)
         center[i] = (_min[i]+_max[i])/2;
     }
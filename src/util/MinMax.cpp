@@ -0,0 +1,246 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// MinMax.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <float.h>
+#include <mutex>
+#include "MinMax.hpp"
+#include "ThreadPool.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MIN_MAX_X86
+#include <immintrin.h>
+#elif defined(_M_X64)
+#define MIN_MAX_SSE2_ONLY
+#include <emmintrin.h>
+#endif
+
+// points per range of the parallel reduction
+static const int s_minRange = 1<<18;
+
+//////////////////////////////////////////////////////////////////////
+// scalar version, also used for the points left over by the SIMD
+// versions; extends min and max
+
+static void computeScalar
+(const float* coord, const int iP0, const int iP1, const int d,
+ float* min, float* max) {
+  const float* p = coord+(size_t)d*iP0;
+  for(int iP=iP0;iP<iP1;iP++,p+=d)
+    for(int i=0;i<d;i++) {
+      if(p[i]<min[i]) min[i] = p[i];
+      if(p[i]>max[i]) max[i] = p[i];
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+// SIMD versions, for 1<=d<=4; each block of W points is loaded as d
+// registers, and the new values are the first operands of min and
+// max, which return the second one when either is a NaN
+
+#if defined(MIN_MAX_X86) || defined(MIN_MAX_SSE2_ONLY)
+
+#ifdef MIN_MAX_X86
+__attribute__((target("sse2")))
+#endif
+static void computeSse2
+(const float* coord, const int iP0, const int iP1, const int d,
+ float* min, float* max) {
+  const int W = 4;
+  __m128 lo[4],hi[4];
+  int i,j,iP = iP0;
+  for(j=0;j<d;j++) {
+    lo[j] = _mm_set1_ps( FLT_MAX);
+    hi[j] = _mm_set1_ps(-FLT_MAX);
+  }
+  for(;iP+W<=iP1;iP+=W) {
+    const float* p = coord+(size_t)d*iP;
+    for(j=0;j<d;j++,p+=W) {
+      __m128 v = _mm_loadu_ps(p);
+      lo[j] = _mm_min_ps(v,lo[j]);
+      hi[j] = _mm_max_ps(v,hi[j]);
+    }
+  }
+  // lane k of the j-th register holds coordinate (W*j+k)%d
+  float x[W],y[W];
+  for(j=0;j<d;j++) {
+    _mm_storeu_ps(x,lo[j]);
+    _mm_storeu_ps(y,hi[j]);
+    for(int k=0;k<W;k++) {
+      i = (W*j+k)%d;
+      if(x[k]<min[i]) min[i] = x[k];
+      if(y[k]>max[i]) max[i] = y[k];
+    }
+  }
+  computeScalar(coord,iP,iP1,d,min,max);
+}
+
+#endif // MIN_MAX_X86 || MIN_MAX_SSE2_ONLY
+
+#ifdef MIN_MAX_X86
+
+__attribute__((target("avx2")))
+static void computeAvx2
+(const float* coord, const int iP0, const int iP1, const int d,
+ float* min, float* max) {
+  const int W = 8;
+  __m256 lo[4],hi[4];
+  int i,j,iP = iP0;
+  for(j=0;j<d;j++) {
+    lo[j] = _mm256_set1_ps( FLT_MAX);
+    hi[j] = _mm256_set1_ps(-FLT_MAX);
+  }
+  for(;iP+W<=iP1;iP+=W) {
+    const float* p = coord+(size_t)d*iP;
+    for(j=0;j<d;j++,p+=W) {
+      __m256 v = _mm256_loadu_ps(p);
+      lo[j] = _mm256_min_ps(v,lo[j]);
+      hi[j] = _mm256_max_ps(v,hi[j]);
+    }
+  }
+  // lane k of the j-th register holds coordinate (W*j+k)%d
+  float x[W],y[W];
+  for(j=0;j<d;j++) {
+    _mm256_storeu_ps(x,lo[j]);
+    _mm256_storeu_ps(y,hi[j]);
+    for(int k=0;k<W;k++) {
+      i = (W*j+k)%d;
+      if(x[k]<min[i]) min[i] = x[k];
+      if(y[k]>max[i]) max[i] = y[k];
+    }
+  }
+  computeScalar(coord,iP,iP1,d,min,max);
+}
+
+#endif // MIN_MAX_X86
+
+//////////////////////////////////////////////////////////////////////
+static MinMax::Isa detectIsa() {
+#if defined(MIN_MAX_X86)
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2")) return MinMax::ISA_AVX2;
+  if(__builtin_cpu_supports("sse2")) return MinMax::ISA_SSE2;
+#elif defined(MIN_MAX_SSE2_ONLY)
+  return MinMax::ISA_SSE2;
+#endif
+  return MinMax::ISA_SCALAR;
+}
+
+static MinMax::Isa s_supportedIsa = detectIsa();
+static MinMax::Isa s_isa          = s_supportedIsa;
+
+MinMax::Isa MinMax::getSupportedIsa() {
+  return s_supportedIsa;
+}
+
+MinMax::Isa MinMax::getIsa() {
+  return s_isa;
+}
+
+void MinMax::setIsa(const Isa isa) {
+  s_isa = (isa<s_supportedIsa)?isa:s_supportedIsa;
+}
+
+const char* MinMax::getIsaName(const Isa isa) {
+  switch(isa) {
+  case ISA_SSE2: return "sse2";
+  case ISA_AVX2: return "avx2";
+  default:       return "scalar";
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+// extends min and max with the points in [iP0,iP1)
+static void computeRange
+(const float* coord, const int iP0, const int iP1, const int d,
+ float* min, float* max) {
+  if(d>4) {
+    computeScalar(coord,iP0,iP1,d,min,max);
+    return;
+  }
+  switch(s_isa) {
+#if defined(MIN_MAX_X86)
+  case MinMax::ISA_AVX2:
+    computeAvx2(coord,iP0,iP1,d,min,max);
+    break;
+#endif
+#if defined(MIN_MAX_X86) || defined(MIN_MAX_SSE2_ONLY)
+  case MinMax::ISA_SSE2:
+    computeSse2(coord,iP0,iP1,d,min,max);
+    break;
+#endif
+  default:
+    computeScalar(coord,iP0,iP1,d,min,max);
+    break;
+  }
+}
+
+void MinMax::compute
+(const float* coord, const int nP, const int d, float* min, float* max) {
+  if(d<=0) return;
+  int i;
+  for(i=0;i<d;i++) {
+    min[i] =  FLT_MAX;
+    max[i] = -FLT_MAX;
+  }
+  if(nP<=0) return;
+  if(nP<2*s_minRange) {
+    computeRange(coord,0,nP,d,min,max);
+    return;
+  }
+  // each range reduces into its own bounds, which are then merged
+  mutex lock;
+  ThreadPool::getInstance().runRange(nP,s_minRange,[&](int iP0, int iP1) {
+      vector<float> bounds(2*d);
+      float* rMin = bounds.data();
+      float* rMax = rMin+d;
+      for(int j=0;j<d;j++) {
+        rMin[j] =  FLT_MAX;
+        rMax[j] = -FLT_MAX;
+      }
+      computeRange(coord,iP0,iP1,d,rMin,rMax);
+      lock_guard<mutex> guard(lock);
+      for(int j=0;j<d;j++) {
+        if(rMin[j]<min[j]) min[j] = rMin[j];
+        if(rMax[j]>max[j]) max[j] = rMax[j];
+      }
+    });
+}
+
+void MinMax::compute
+(const float* const* coord, const int nP, const int d,
+ float* min, float* max) {
+  for(int i=0;i<d;i++)
+    compute(coord[i],nP,1,min+i,max+i);
+}
@@ -0,0 +1,79 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// MinMax.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _MIN_MAX_HPP_
+#define _MIN_MAX_HPP_
+
+// Minimum and maximum of each coordinate of a set of points, stored
+// either interleaved, as nP groups of d consecutive floats, or as d
+// separate arrays of nP floats.
+//
+// Interleaved points with at most four coordinates are reduced with
+// SIMD registers of 8 (AVX2) or 4 (SSE2) lanes; since the registers
+// of each block of W points start at multiples of W*d floats, every
+// lane always sees the same coordinate, and only the final lanes are
+// combined per coordinate. Large arrays are split among the threads
+// of the ThreadPool. NaN values are ignored, as by the scalar code,
+// and since min and max are exact the results do not depend on the
+// instruction set or on the number of threads.
+
+class MinMax {
+
+public:
+
+  enum Isa { ISA_SCALAR = 0, ISA_SSE2, ISA_AVX2 };
+
+  // best instruction set supported by the processor
+  static Isa         getSupportedIsa();
+
+  // instruction set used by compute(); initially the supported one
+  static Isa         getIsa();
+  static const char* getIsaName(const Isa isa);
+
+  // values above the supported instruction set are clamped
+  static void        setIsa(const Isa isa);
+
+  // min[0..d-1] and max[0..d-1] of nP interleaved points; if nP<=0
+  // the min values are set to FLT_MAX and the max values to -FLT_MAX
+  static void        compute(const float* coord, const int nP, const int d,
+                             float* min, float* max);
+
+  // same for the d arrays coord[0..d-1] of nP values each
+  static void        compute(const float* const* coord,
+                             const int nP, const int d,
+                             float* min, float* max);
+
+};
+
+#endif /* _MIN_MAX_HPP_ */
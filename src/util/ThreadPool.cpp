@@ -0,0 +1,154 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// ThreadPool.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "ThreadPool.hpp"
+
+// true in the worker threads, and in a thread running a parallel loop
+static thread_local bool s_inPool = false;
+
+ThreadPool::ThreadPool(const int nThreads):
+  _busy(false),
+  _quit(false),
+  _generation(0),
+  _nTasks(0),
+  _nextTask(0),
+  _nActive(0),
+  _task((const function<void(int)>*)0) {
+  int n = nThreads;
+  if(n<=0) n = (int)thread::hardware_concurrency();
+  if(n<=0) n = 1;
+  for(int i=1;i<n;i++)
+    _workers.push_back(thread(&ThreadPool::_work,this));
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    unique_lock<mutex> lock(_mutex);
+    _quit = true;
+  }
+  _wake.notify_all();
+  for(size_t i=0;i<_workers.size();i++)
+    _workers[i].join();
+}
+
+ThreadPool& ThreadPool::getInstance() {
+  static ThreadPool pool;
+  return pool;
+}
+
+int ThreadPool::getNumberOfThreads() const {
+  return (int)_workers.size()+1;
+}
+
+void ThreadPool::_runTasks() {
+  int i;
+  while((i=_nextTask.fetch_add(1))<_nTasks)
+    (*_task)(i);
+}
+
+void ThreadPool::_work() {
+  s_inPool = true;
+  unsigned generation = 0;
+  while(true) {
+    {
+      unique_lock<mutex> lock(_mutex);
+      while(_quit==false && _generation==generation)
+        _wake.wait(lock);
+      if(_quit) return;
+      generation = _generation;
+      _nActive++;
+    }
+    _runTasks();
+    {
+      unique_lock<mutex> lock(_mutex);
+      if(--_nActive==0) _done.notify_all();
+    }
+  }
+}
+
+void ThreadPool::run(const int nTasks, const function<void(int)>& task) {
+  if(nTasks<=0) return;
+
+  bool serial = (s_inPool || _workers.size()==0 || nTasks==1);
+  if(serial==false) {
+    unique_lock<mutex> lock(_mutex);
+    if(_busy) serial = true; else _busy = true;
+  }
+  if(serial) {
+    for(int i=0;i<nTasks;i++) task(i);
+    return;
+  }
+
+  {
+    // a worker which woke up late for the previous loop may still be
+    // checking for tasks
+    unique_lock<mutex> lock(_mutex);
+    while(_nActive>0) _done.wait(lock);
+    _task     = &task;
+    _nTasks   = nTasks;
+    _nextTask = 0;
+    _generation++;
+  }
+  _wake.notify_all();
+
+  s_inPool = true;
+  _runTasks();
+  s_inPool = false;
+
+  {
+    // wait for the workers which picked up this loop
+    unique_lock<mutex> lock(_mutex);
+    while(_nActive>0) _done.wait(lock);
+    _task   = (const function<void(int)>*)0;
+    _nTasks = 0;
+    _busy   = false;
+  }
+}
+
+void ThreadPool::runRange
+(const int n, const int minSize, const function<void(int,int)>& range) {
+  if(n<=0) return;
+  int size = (minSize>1)?minSize:1;
+  int nRanges = 4*getNumberOfThreads();
+  if(nRanges>(n+size-1)/size) nRanges = (n+size-1)/size;
+  if(nRanges<=1) {
+    range(0,n);
+    return;
+  }
+  run(nRanges,[&](int k) {
+      int i0 = (int)(((long long)n*k)/nRanges);
+      int i1 = (int)(((long long)n*(k+1))/nRanges);
+      range(i0,i1);
+    });
+}
@@ -0,0 +1,101 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-01-26 17:42:17 taubin>
+//------------------------------------------------------------------------
+//
+// ThreadPool.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _THREAD_POOL_HPP_
+#define _THREAD_POOL_HPP_
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+
+using namespace std;
+
+// Fixed set of worker threads which run the tasks of a parallel loop.
+// The run() method executes task(i) for every i in [0,nTasks), with
+// the calling thread taking part in the work, and returns when all
+// the tasks are done. Tasks are handed out dynamically, one index at
+// a time, so that chunks of uneven cost are balanced among threads.
+//
+// A run() called from within a task, or from a second thread while
+// the pool is busy, executes its tasks serially in the calling thread
+// rather than waiting for the pool.
+
+class ThreadPool {
+
+public:
+
+  // nThreads<=0 uses the number of hardware threads
+                ThreadPool(const int nThreads=0);
+                ~ThreadPool();
+
+  // pool shared by the whole application
+  static ThreadPool& getInstance();
+
+  // includes the calling thread
+  int           getNumberOfThreads() const;
+
+  void          run(const int nTasks, const function<void(int)>& task);
+
+  // splits [0,n) into contiguous ranges of at least minSize indices,
+  // about four per thread, and runs range(i0,i1) for each of them
+  void          runRange(const int n, const int minSize,
+                         const function<void(int,int)>& range);
+
+private:
+
+  // not copyable
+                ThreadPool(const ThreadPool&);
+  ThreadPool&   operator=(const ThreadPool&);
+
+  void          _work();
+  void          _runTasks();
+
+  vector<thread>             _workers;
+  mutex                      _mutex;
+  condition_variable         _wake;
+  condition_variable         _done;
+  bool                       _busy;
+  bool                       _quit;
+  unsigned                   _generation;
+  int                        _nTasks;
+  atomic<int>                _nextTask;
+  int                        _nActive;
+  const function<void(int)>* _task;
+
+};
+
+#endif /* _THREAD_POOL_HPP_ */
@@ -34,11 +34,13 @@
 
 #include <iostream>
 #include <math.h>
+#include <float.h>
 #include <algorithm>
 #include "Transform.hpp"
 #include "Shape.hpp"
 #include "IndexedFaceSet.hpp"
 #include "IndexedLineSet.hpp"
+#include "util/MinMax.hpp"
   
 Group::Group():
 _bboxCenter(0.0f,0.0f,0.0f),
@@ -98,6 +100,7 @@ float Group::getBBoxDiameter() {
 void Group::addChild(const pNode child) {
   child->setParent(this);
   _children.push_back(child);
+  invalidateBBox();
 }
 
 void Group::removeChild(const pNode child) {
@@ -105,7 +108,8 @@ void Group::removeChild(const pNode child) {
   node = find(_children.begin(),_children.end(),child);
   if(node!=_children.end()) {
     _children.erase(node);
-    delete &(*node);
+    delete child;
+    invalidateBBox();
   }
 }
 
@@ -121,7 +125,8 @@ void Group::clearBBox() {
   _bboxSize.x   = _bboxSize.y   = _bboxSize.z = -1.0f;
 }
 bool Group::hasEmptyBBox() const {
-  return (_bboxSize.x<=0.0f ||_bboxSize.y<=0.0f ||_bboxSize.z<=0.0f);
+  // flat boxes, such as those of planar geometry, are not empty
+  return (_bboxSize.x<0.0f ||_bboxSize.y<0.0f ||_bboxSize.z<0.0f);
 }
 
 void Group::appendBBoxCoord(vector<float>& coord) {
@@ -161,13 +166,14 @@ void Group::updateBBox(vector<float>& coord) {
     max.x = _bboxCenter.x+0.5f*_bboxSize.x;
     max.y = _bboxCenter.y+0.5f*_bboxSize.y;
     max.z = _bboxCenter.z+0.5f*_bboxSize.z;
-    int nCoord = (int)(coord.size()/3);
-    for(int i=0;i<nCoord;i++) {
-      Vec3f p(coord[3*i+0],coord[3*i+1],coord[3*i+2]);
-      if(p.x<min.x) min.x = p.x; else if(p.x>max.x) max.x = p.x;
-      if(p.y<min.y) min.y = p.y; else if(p.y>max.y) max.y = p.y;
-      if(p.z<min.z) min.z = p.z; else if(p.z>max.z) max.z = p.z;
-    }
+    float cMin[3],cMax[3];
+    MinMax::compute(coord.data(),(int)(coord.size()/3),3,cMin,cMax);
+    if(cMin[0]<min.x) min.x = cMin[0];
+    if(cMax[0]>max.x) max.x = cMax[0];
+    if(cMin[1]<min.y) min.y = cMin[1];
+    if(cMax[1]>max.y) max.y = cMax[1];
+    if(cMin[2]<min.z) min.z = cMin[2];
+    if(cMax[2]>max.z) max.z = cMax[2];
   _bboxCenter.x = (max.x+min.x)/2.0f;
   _bboxCenter.y = (max.y+min.y)/2.0f;
   _bboxCenter.z = (max.z+min.z)/2.0f;
@@ -177,44 +183,84 @@ void Group::updateBBox(vector<float>& coord) {
   }
 }
 
+// extends min,max to contain the box of a Group, mapped by the matrix
+// of a Transform, if not null
+static void addBBox(Vec3f& min, Vec3f& max, Group& group, float* M) {
+  Vec3f& c = group.getBBoxCenter();
+  Vec3f& s = group.getBBoxSize();
+  float center[3] = { c.x, c.y, c.z };
+  float extent[3] = { 0.5f*s.x, 0.5f*s.y, 0.5f*s.z };
+  if(M!=(float*)0) {
+    // the box centered at M*center, with the half sides given by the
+    // absolute values of the entries of the linear part of M
+    float mc[3],me[3];
+    int i,ii,j;
+    for(ii=i=0;i<3;ii+=4,i++) {
+      for(mc[i]=M[ii+3],me[i]=0.0f,j=0;j<3;j++) {
+        mc[i] += M[ii+j]*center[j];
+        me[i] += fabsf(M[ii+j])*extent[j];
+      }
+    }
+    for(i=0;i<3;i++) {
+      center[i] = mc[i];
+      extent[i] = me[i];
+    }
+  }
+  if(center[0]-extent[0]<min.x) min.x = center[0]-extent[0];
+  if(center[0]+extent[0]>max.x) max.x = center[0]+extent[0];
+  if(center[1]-extent[1]<min.y) min.y = center[1]-extent[1];
+  if(center[1]+extent[1]>max.y) max.y = center[1]+extent[1];
+  if(center[2]-extent[2]<min.z) min.z = center[2]-extent[2];
+  if(center[2]+extent[2]>max.z) max.z = center[2]+extent[2];
+}
+
+// The box of each Group is in the coordinates of its children, and is
+// the union of the boxes of the Shapes and Groups among them, with
+// those of the Transforms mapped by their matrices. The boxes are
+// recomputed only for the Groups and Shapes invalidated since the
+// last call, so that the box of a SceneGraph is in world coordinates,
+// and repeated calls cost nothing.
 void Group::updateBBox() {
+  if(_bboxValid) return;
+  Vec3f min( FLT_MAX, FLT_MAX, FLT_MAX);
+  Vec3f max(-FLT_MAX,-FLT_MAX,-FLT_MAX);
   int nChildren = getNumberOfChildren();
   for(int i=0;i<nChildren;i++) {
     Node* node = (*this)[i];
-    if(node->isTransform()) {
-      Transform* transform = (Transform*)node;
-      transform->updateBBox();
-      // get vertices of bounding box
-      vector<float> coord;
-      transform->appendBBoxCoord(coord);
-      // apply the transform to thoe vertices
-      // TODO Thu Nov 08 18:25:47 2012
-      // update this group bounding box
-      updateBBox(coord);
-    } else if(node->isGroup()) {
+    if(node->isGroup()) {
       Group* group = (Group*)node;
       group->updateBBox();
-      // get vertices of bounding box
-      vector<float> coord;
-      group->appendBBoxCoord(coord);
-      // update this group bounding box
-      updateBBox(coord);
+      if(group->hasEmptyBBox()) continue;
+      if(node->isTransform()) {
+        float M[16];
+        ((Transform*)node)->getMatrix(M);
+        addBBox(min,max,*group,M);
+      } else {
+        addBBox(min,max,*group,(float*)0);
+      }
     } else if(node->isShape()) {
-      Shape* shape = (Shape*)node;
-      node = shape->getGeometry();
-      if(node!=(Node*)0 && node->isIndexedFaceSet()) {
-        IndexedFaceSet* pIfs = (IndexedFaceSet*)node;
-        vector<float> &coord = pIfs->getCoord();    
-        // update this group bounding box
-        updateBBox(coord);
-      } else if(node!=(Node*)0 && node->isIndexedLineSet()) {
-        IndexedLineSet* pIls = (IndexedLineSet*)node;
-        vector<float> &coord = pIls->getCoord();    
-        // update this group bounding box
-        updateBBox(coord);
+      Vec3f bMin,bMax;
+      if(((Shape*)node)->getBBox(bMin,bMax)) {
+        if(bMin.x<min.x) min.x = bMin.x;
+        if(bMax.x>max.x) max.x = bMax.x;
+        if(bMin.y<min.y) min.y = bMin.y;
+        if(bMax.y>max.y) max.y = bMax.y;
+        if(bMin.z<min.z) min.z = bMin.z;
+        if(bMax.z>max.z) max.z = bMax.z;
       }
     }
   }
+  if(min.x>max.x) {
+    clearBBox();
+  } else {
+    _bboxCenter.x = (max.x+min.x)/2.0f;
+    _bboxCenter.y = (max.y+min.y)/2.0f;
+    _bboxCenter.z = (max.z+min.z)/2.0f;
+    _bboxSize.x   = (max.x-min.x);
+    _bboxSize.y   = (max.y-min.y);
+    _bboxSize.z   = (max.z-min.z);
+  }
+  _bboxValid = true;
 }
 
 void Group::printInfo(string indent) {
@@ -77,6 +77,7 @@ public:
   bool                  hasEmptyBBox() const;
   void                  appendBBoxCoord(vector<float>& coord);
   void                  updateBBox(vector<float>& coord);
+  // recomputes the cached boxes which have been invalidated
   virtual void          updateBBox();
 
   virtual bool          isGroup() const { return    true; };
@@ -33,8 +33,12 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <iostream>
+#include <climits>
 #include "IndexedFaceSet.hpp"
 
+// maximum number of ranges kept for each type of change
+#define MAX_CHANGED_RANGES 1024
+
 // VRML'97
 //
 // IndexedFaceSet {
@@ -64,6 +68,7 @@ IndexedFaceSet::IndexedFaceSet():
   _creaseAngle(0),
   _solid(true),
   _normalPerVertex(true),
+  _normalWeight(-1),
   _colorPerVertex(true)
 {}
 
@@ -73,6 +78,7 @@ void IndexedFaceSet::clear() {
   _creaseAngle     = 0.0;
   _solid           = true;
   _normalPerVertex = true;
+  _normalWeight    = -1;
   _colorPerVertex  = true;
   _coord.clear();
   _coordIndex.clear();
@@ -82,6 +88,7 @@ void IndexedFaceSet::clear() {
   _colorIndex.clear();
   _texCoord.clear();
   _texCoordIndex.clear();
+  clearChanged();
 }
 
 bool&          IndexedFaceSet::getCcw()              { return _ccw;                }
@@ -214,6 +221,69 @@ void IndexedFaceSet::setColorPerVertex(bool value) {
   _colorPerVertex = value;
 }
 
+int IndexedFaceSet::getNormalWeight() {
+  return _normalWeight;
+}
+
+void IndexedFaceSet::setNormalWeight(int value) {
+  _normalWeight = value;
+}
+
+void IndexedFaceSet::setChanged(Change c, int i0, int i1) {
+  if(c<0 || c>=CHANGE_TYPES) return;
+  if(i0<0) i0 = 0;
+  if(i1<=i0) return;
+  vector<int>& range = _changed[c];
+  int n = (int)range.size();
+  if(n>0 && i0<=range[n-1] && i1>=range[n-2]) {
+    // merge with the last range
+    if(i0<range[n-2]) range[n-2] = i0;
+    if(i1>range[n-1]) range[n-1] = i1;
+  } else if(n>=2*MAX_CHANGED_RANGES) {
+    // collapse into one range covering all of them
+    int j0 = i0, j1 = i1;
+    for(int j=0;j<n;j+=2) {
+      if(range[j  ]<j0) j0 = range[j  ];
+      if(range[j+1]>j1) j1 = range[j+1];
+    }
+    range.clear();
+    range.push_back(j0);
+    range.push_back(j1);
+  } else {
+    range.push_back(i0);
+    range.push_back(i1);
+  }
+  if(c==CHANGED_COORD) {
+    setChanged(STALE_NORMAL,i0,i1);
+    invalidateBBox();
+  } else if(c==CHANGED_COORD_INDEX) {
+    setChanged(STALE_NORMAL);
+  }
+}
+
+void IndexedFaceSet::setChanged(Change c) {
+  if(c<0 || c>=CHANGE_TYPES) return;
+  _changed[c].clear();
+  setChanged(c,0,INT_MAX);
+}
+
+bool IndexedFaceSet::hasChanged(Change c) {
+  return (c>=0 && c<CHANGE_TYPES && _changed[c].size()>0);
+}
+
+vector<int>& IndexedFaceSet::getChanged(Change c) {
+  return _changed[(c>=0 && c<CHANGE_TYPES)?c:CHANGED_COORD];
+}
+
+void IndexedFaceSet::clearChanged(Change c) {
+  if(c>=0 && c<CHANGE_TYPES) _changed[c].clear();
+}
+
+void IndexedFaceSet::clearChanged() {
+  for(int c=0;c<CHANGE_TYPES;c++)
+    _changed[c].clear();
+}
+
 void IndexedFaceSet::printInfo(string indent) {
   std::cout << indent;
   if(_name!="") std::cout << "DEF " << _name << " ";
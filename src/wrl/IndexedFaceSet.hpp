@@ -65,6 +65,31 @@ using namespace std;
 
 class IndexedFaceSet : public Node {
 
+public:
+
+  // Change tracking. Code which modifies coord, normal or color in
+  // place records the modified ranges [i0,i1), in units of vertices,
+  // normals or colors, so that the consumers of the data can update
+  // only the affected parts. The CHANGED_* ranges are meant for the
+  // renderer; recording coordinate changes also marks the normals of
+  // those vertices as STALE_NORMAL, which the normal operators of
+  // SceneGraphProcessor use to recompute only the normals of the
+  // affected faces and vertices. Each consumer clears the ranges it has
+  // processed. Edits of the coordIndex of existing faces are recorded
+  // as CHANGED_COORD_INDEX ranges, in units of corners; they mark all
+  // the normals as stale, since the faces of the vertices may have
+  // changed, and the renderer rebuilds the buffers of the faces. Ranges
+  // are kept in insertion order, with adjacent or overlapping ranges
+  // merged; too many ranges are collapsed into one.
+  enum Change {
+    CHANGED_COORD = 0,
+    CHANGED_NORMAL,
+    CHANGED_COLOR,
+    CHANGED_COORD_INDEX,
+    STALE_NORMAL,
+    CHANGE_TYPES // number of change types
+  };
+
 private:
 
   bool           _ccw;
@@ -78,6 +103,7 @@ private:
   bool           _normalPerVertex;
   vector<float>  _normal;
   vector<int>    _normalIndex;
+  int            _normalWeight;
 
   bool           _colorPerVertex;
   vector<float>  _color;
@@ -86,6 +112,8 @@ private:
   vector<float>  _texCoord;
   vector<int>    _texCoordIndex;
 
+  vector<int>    _changed[CHANGE_TYPES];
+
 public:
   
   IndexedFaceSet();
@@ -118,6 +146,22 @@ public:
   void            setNormalPerVertex(bool value);
   void            setColorPerVertex(bool value);
 
+  // weighting of the face normals used to compute the per-vertex
+  // normals, as a SceneGraphProcessor::NormalWeight value, so that
+  // they are only updated incrementally with the same weighting; -1
+  // for normals of other origins, such as those loaded from files
+  int             getNormalWeight();
+  void            setNormalWeight(int value);
+
+  // change tracking, as described above the Change enum
+  void            setChanged(Change c, int i0, int i1);
+  void            setChanged(Change c); // everything
+  bool            hasChanged(Change c);
+  // pairs i0,i1; i1 may exceed the size of the data
+  vector<int>&    getChanged(Change c);
+  void            clearChanged(Change c);
+  void            clearChanged();
+
   enum Binding {
     PB_NONE = 0,
     PB_PER_VERTEX,
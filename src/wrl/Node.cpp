@@ -160,7 +160,8 @@ void Vec4f::normalize() {
 Node::Node():
   _name(""),
   _parent((Node*)0),
-  _show(true) {
+  _show(true),
+  _bboxValid(false) {
 }
 
 Node::~Node() {
@@ -207,6 +208,19 @@ int Node::getDepth() const {
   return d;
 }
 
+// A node out of date implies that the nodes above it are also out of
+// date, so that the walk can stop there.
+void Node::invalidateBBox() {
+  Node* node = this;
+  while(node!=(Node*)0) {
+    if(node->isGroup() || node->isShape()) {
+      if(node->_bboxValid==false) break;
+      node->_bboxValid = false;
+    }
+    node = (Node*)(node->_parent);
+  }
+}
+
 bool    Node::isAppearance() const     { return  false; }
 bool    Node::isGroup() const          { return  false; }
 bool    Node::isImageTexture() const   { return  false; }
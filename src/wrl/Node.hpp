@@ -93,6 +93,7 @@ protected:
   string      _name;
   const Node* _parent;
   bool        _show;
+  bool        _bboxValid; // Groups and Shapes only
 
 public:
   
@@ -108,6 +109,13 @@ public:
   void            setShow(const bool value);
   int             getDepth() const; 
 
+  // Groups and Shapes cache their bounding boxes; this marks the
+  // boxes of this node and of the nodes above it as out of date. It
+  // must be called after changes which are not made through addChild,
+  // removeChild, setGeometry, the Transform setters, or
+  // IndexedFaceSet::setChanged(CHANGED_COORD).
+  void            invalidateBBox();
+
   virtual bool    isAppearance() const;
   virtual bool    isGroup() const;
   virtual bool    isImageTexture() const;
@@ -34,6 +34,7 @@
 
 #include <math.h>
 #include <iostream>
+#include <atomic>
 #include "SceneGraphProcessor.hpp"
 #include "SceneGraphTraversal.hpp"
 #include "Shape.hpp"
@@ -41,6 +42,81 @@
 #include "IndexedLineSet.hpp"
 #include "Appearance.hpp"
 #include "Material.hpp"
+#include "core/Edges.hpp"
+#include "core/VertexWeld.hpp"
+#include "core/TriangleNormals.hpp"
+#include "util/ThreadPool.hpp"
+
+// IndexedFaceSets with at least this many corners are processed one at
+// a time, with the operators running in parallel within each of them;
+// the smaller ones are distributed among the threads
+#define PARALLEL_MIN_CORNERS 65536
+
+// Weighting policies of _computeNormalPerVertexWeighted and
+// _updateNormalPerVertex. Each one computes the contribution of a face
+// to the normal of the vertex p, where pPrev and pNext are the previous
+// and next face vertices, and nF is the face normal, only computed if
+// FACE_NORMAL is true, and normalized if UNIT_FACE_NORMAL is true. The
+// policy is a template parameter, so that the loop over the corners is
+// compiled once for each one, without branches on the weighting.
+
+// face normal, which is scaled by twice the face area when not
+// normalized; the full computation of the area weighted normals is
+// done by _computeNormalPerVertex, which adds the same terms in the
+// same order
+struct AreaWeight {
+  static const int  WEIGHT           =
+    SceneGraphProcessor::NORMAL_WEIGHT_AREA;
+  static const bool FACE_NORMAL      = true;
+  static const bool UNIT_FACE_NORMAL = false;
+  static inline void corner
+  (const float* /*p*/, const float* /*pPrev*/, const float* /*pNext*/,
+   const float* nF, float* n) {
+    n[0] = nF[0]; n[1] = nF[1]; n[2] = nF[2];
+  }
+};
+
+// unit face normal scaled by the interior angle of the face at p
+struct AngleWeight {
+  static const int  WEIGHT           =
+    SceneGraphProcessor::NORMAL_WEIGHT_ANGLE;
+  static const bool FACE_NORMAL      = true;
+  static const bool UNIT_FACE_NORMAL = true;
+  static inline void corner
+  (const float* p, const float* pPrev, const float* pNext,
+   const float* nF, float* n) {
+    float a0 = pNext[0]-p[0], a1 = pNext[1]-p[1], a2 = pNext[2]-p[2];
+    float b0 = pPrev[0]-p[0], b1 = pPrev[1]-p[1], b2 = pPrev[2]-p[2];
+    float c0 = a1*b2-a2*b1, c1 = a2*b0-a0*b2, c2 = a0*b1-a1*b0;
+    float s = (float)sqrt(c0*c0+c1*c1+c2*c2);
+    float angle = (float)atan2(s,a0*b0+a1*b1+a2*b2);
+    // reflex corner of a non-convex polygon
+    if(c0*nF[0]+c1*nF[1]+c2*nF[2]<0.0f)
+      angle = 2.0f*3.14159265f-angle;
+    n[0] = angle*nF[0]; n[1] = angle*nF[1]; n[2] = angle*nF[2];
+  }
+};
+
+// cross product of the two edges incident to p divided by the product
+// of their squared lengths; exact for vertices on a sphere (Max, 1999)
+struct EdgeWeight {
+  static const int  WEIGHT           =
+    SceneGraphProcessor::NORMAL_WEIGHT_EDGE;
+  static const bool FACE_NORMAL      = false;
+  static const bool UNIT_FACE_NORMAL = false;
+  static inline void corner
+  (const float* p, const float* pPrev, const float* pNext,
+   const float* /*nF*/, float* n) {
+    float a0 = pNext[0]-p[0], a1 = pNext[1]-p[1], a2 = pNext[2]-p[2];
+    float b0 = pPrev[0]-p[0], b1 = pPrev[1]-p[1], b2 = pPrev[2]-p[2];
+    float d = (a0*a0+a1*a1+a2*a2)*(b0*b0+b1*b1+b2*b2);
+    if(d>0.0f) {
+      n[0] = (a1*b2-a2*b1)/d; n[1] = (a2*b0-a0*b2)/d; n[2] = (a0*b1-a1*b0)/d;
+    } else {
+      n[0] = n[1] = n[2] = 0.0f;
+    }
+  }
+};
 
 SceneGraphProcessor::SceneGraphProcessor(SceneGraph& wrl):
   _wrl(wrl) {
@@ -61,15 +137,51 @@ void SceneGraphProcessor::computeNormalPerFace() {
   _applyToIndexedFaceSet(_computeNormalPerFace);
 }
 
-void SceneGraphProcessor::computeNormalPerVertex() {
-  _applyToIndexedFaceSet(_computeNormalPerVertex);
+void SceneGraphProcessor::computeNormalPerVertex(NormalWeight weight) {
+  switch(weight) {
+  case NORMAL_WEIGHT_ANGLE:
+    _applyToIndexedFaceSet(_computeNormalPerVertexWeighted<AngleWeight>);
+    break;
+  case NORMAL_WEIGHT_EDGE:
+    _applyToIndexedFaceSet(_computeNormalPerVertexWeighted<EdgeWeight>);
+    break;
+  default: // NORMAL_WEIGHT_AREA
+    _applyToIndexedFaceSet(_computeNormalPerVertex);
+    break;
+  }
+}
+
+void SceneGraphProcessor::recomputeNormalPerVertex(NormalWeight weight) {
+  switch(weight) {
+  case NORMAL_WEIGHT_ANGLE:
+    _applyToIndexedFaceSet(_recomputeNormalPerVertex<AngleWeight>);
+    break;
+  case NORMAL_WEIGHT_EDGE:
+    _applyToIndexedFaceSet(_recomputeNormalPerVertex<EdgeWeight>);
+    break;
+  default: // NORMAL_WEIGHT_AREA
+    _applyToIndexedFaceSet(_recomputeNormalPerVertex<AreaWeight>);
+    break;
+  }
 }
 
 void SceneGraphProcessor::computeNormalPerCorner() {
   _applyToIndexedFaceSet(_computeNormalPerCorner);
 }
 
+template<class Weight>
+void SceneGraphProcessor::_recomputeNormalPerVertex(IndexedFaceSet& ifs) {
+  if(ifs.getNormalBinding()!=IndexedFaceSet::PB_PER_VERTEX) return;
+  // normals of unknown weighting are never updated incrementally
+  ifs.setNormalWeight(-1);
+  if(Weight::WEIGHT==NORMAL_WEIGHT_AREA)
+    _computeNormalPerVertex(ifs);
+  else
+    _computeNormalPerVertexWeighted<Weight>(ifs);
+}
+
 void SceneGraphProcessor::_applyToIndexedFaceSet(IndexedFaceSet::Operator o) {
+  vector<IndexedFaceSet*> small;
   SceneGraphTraversal traversal(_wrl);
   traversal.start();
   Node* node;
@@ -79,24 +191,58 @@ void SceneGraphProcessor::_applyToIndexedFaceSet(IndexedFaceSet::Operator o) {
       node = shape->getGeometry();
       if(node!=(Node*)0 && node->isIndexedFaceSet()) {
         IndexedFaceSet& ifs = *((IndexedFaceSet*)node);
-        o(ifs);
+        if(ifs.getCoordIndex().size()>=PARALLEL_MIN_CORNERS)
+          o(ifs);
+        else
+          small.push_back(&ifs);
       }
     }
   }
+  ThreadPool::getInstance().run((int)small.size(),[&](int i) {
+      o(*small[i]);
+    });
 }
 
 void SceneGraphProcessor::_normalClear(IndexedFaceSet& ifs) {
   vector<float>& normal      = ifs.getNormal();
   vector<int>&   normalIndex = ifs.getNormalIndex();
   ifs.setNormalPerVertex(true);
+  ifs.setNormalWeight(-1);
   normal.clear();
   normalIndex.clear();
+  ifs.clearChanged(IndexedFaceSet::STALE_NORMAL);
+  ifs.setChanged(IndexedFaceSet::CHANGED_NORMAL);
 }
 
 void SceneGraphProcessor::_normalInvert(IndexedFaceSet& ifs) {
   vector<float>& normal = ifs.getNormal();
   for(int i=0;i<(int)normal.size();i++)
     normal[i] = -normal[i];
+  // inverted normals are recomputed rather than updated incrementally
+  ifs.setNormalWeight(-1);
+  ifs.setChanged(IndexedFaceSet::CHANGED_NORMAL);
+}
+
+// Number of triangles of a triangle mesh, which TriangleNormals
+// expects to find at the start of coordIndex, four entries each; a
+// trailing face without a -1 separator is ignored, as in the loops
+// over the faces.
+static int getNumberOfTriangles(IndexedFaceSet& ifs) {
+  vector<int>& coordIndex = ifs.getCoordIndex();
+  int nT = (int)(coordIndex.size()/4);
+  while(nT>0 && coordIndex[4*nT-1]>=0) nT--;
+  return nT;
+}
+
+// Face normals of the nT triangles of a triangle mesh, computed in
+// parallel with the SIMD kernel.
+static void computeTriangleNormals
+(vector<float>& coord, vector<int>& coordIndex,
+ int nT, float* normal, bool normalize) {
+  ThreadPool::getInstance().runRange(nT,16384,[&](int iT0, int iT1) {
+      TriangleNormals::compute(coord.data(),coordIndex.data()+4*iT0,
+                               iT1-iT0,normal+3*iT0,normalize);
+    });
 }
 
 void SceneGraphProcessor::_computeFaceNormal
@@ -188,14 +334,27 @@ void SceneGraphProcessor::_computeFaceNormal
 }
 
 void SceneGraphProcessor::_computeNormalPerFace(IndexedFaceSet& ifs) {
-  if(ifs.getNormalBinding()==IndexedFaceSet::PB_PER_FACE) return;
+  if(ifs.getNormalBinding()==IndexedFaceSet::PB_PER_FACE) {
+    if(ifs.hasChanged(IndexedFaceSet::STALE_NORMAL))
+      _updateNormalPerFace(ifs);
+    return;
+  }
   vector<float>& coord       = ifs.getCoord();
   vector<int>&   coordIndex  = ifs.getCoordIndex();
   vector<float>& normal      = ifs.getNormal();
   vector<int>&   normalIndex = ifs.getNormalIndex();
   ifs.setNormalPerVertex(false);
+  ifs.setNormalWeight(-1);
   normal.clear();
   normalIndex.clear();
+  ifs.clearChanged(IndexedFaceSet::STALE_NORMAL);
+  ifs.setChanged(IndexedFaceSet::CHANGED_NORMAL);
+  if(ifs.isTriangleMesh()) {
+    int nT = getNumberOfTriangles(ifs);
+    normal.resize(3*nT);
+    computeTriangleNormals(coord,coordIndex,nT,normal.data(),true);
+    return;
+  }
   Vec3f n;
   int /*iF,*/ i0,i1;
   for(i0=i1=0;i1<(int)coordIndex.size();i1++) {
@@ -209,25 +368,63 @@ void SceneGraphProcessor::_computeNormalPerFace(IndexedFaceSet& ifs) {
   }
 }
 
+// With more than one thread, the face normals are computed in
+// parallel, and then every vertex gathers the normals of its incident
+// faces, in face order, from a vertex-to-face table. Each vertex normal
+// is thus the sum of the same terms, added in the same order, as in the
+// serial loop over the faces, and the result does not depend on the
+// number of threads.
 void SceneGraphProcessor::_computeNormalPerVertex(IndexedFaceSet& ifs) {
-  if(ifs.getNormalBinding()==IndexedFaceSet::PB_PER_VERTEX) return;
+  // normals computed with another weighting are recomputed
+  if(ifs.getNormalBinding()==IndexedFaceSet::PB_PER_VERTEX &&
+     ifs.getNormalWeight()==AreaWeight::WEIGHT) {
+    if(ifs.hasChanged(IndexedFaceSet::STALE_NORMAL))
+      _updateNormalPerVertex<AreaWeight>(ifs);
+    return;
+  }
   vector<float>& coord       = ifs.getCoord();
   vector<int>&   coordIndex  = ifs.getCoordIndex();
   vector<float>& normal      = ifs.getNormal();
   vector<int>&   normalIndex = ifs.getNormalIndex();
   ifs.setNormalPerVertex(true);
+  ifs.setNormalWeight(AreaWeight::WEIGHT);
   normal.clear();
   normalIndex.clear();
-  Vec3f n;
-  int /*iF,*/ nV,i,i0,i1,iV;
-  float x0,x1,x2;
-  nV = (int)(coord.size()/3);
+  ifs.clearChanged(IndexedFaceSet::STALE_NORMAL);
+  ifs.setChanged(IndexedFaceSet::CHANGED_NORMAL);
+  int nV = (int)(coord.size()/3);
   // initialize accumulators
   normal.insert(normal.end(),coord.size(),0.0f);
+
+  ThreadPool& pool = ThreadPool::getInstance();
+  if(pool.getNumberOfThreads()>1 &&
+     coordIndex.size()>=PARALLEL_MIN_CORNERS) {
+    _computeNormalPerVertexParallel(coord,coordIndex,normal,
+                                    ifs.isTriangleMesh());
+    return;
+  }
+
+  // the face normals of triangle meshes are computed in batches
+  vector<float> faceNormal;
+  if(ifs.isTriangleMesh()) {
+    faceNormal.resize(3*getNumberOfTriangles(ifs));
+    computeTriangleNormals(coord,coordIndex,(int)faceNormal.size()/3,
+                            faceNormal.data(),false);
+  }
+
+  Vec3f n;
+  int iF,i,i0,i1,iV;
+  float x0,x1,x2;
   // accumulate face normals
-  for(i0=i1=0;i1<(int)coordIndex.size();i1++) {
+  for(iF=i0=i1=0;i1<(int)coordIndex.size();i1++) {
     if(coordIndex[i1]<0) {
-      _computeFaceNormal(coord,coordIndex,i0,i1,n,false);
+      if(faceNormal.size()>0) {
+        n[0] = faceNormal[3*iF  ];
+        n[1] = faceNormal[3*iF+1];
+        n[2] = faceNormal[3*iF+2];
+      } else {
+        _computeFaceNormal(coord,coordIndex,i0,i1,n,false);
+      }
       // accumulate
       for(i=i0;i<i1;i++) {
         iV = coordIndex[i];
@@ -238,7 +435,7 @@ void SceneGraphProcessor::_computeNormalPerVertex(IndexedFaceSet& ifs) {
         normal[3*iV+1] = x1+((float)(n[1]));
         normal[3*iV+2] = x2+((float)(n[2]));
       }
-      i0=i1+1; /* iF++; */
+      i0=i1+1; iF++;
     }
   }
   for(iV=0;iV<nV;iV++) {
@@ -256,82 +453,499 @@ void SceneGraphProcessor::_computeNormalPerVertex(IndexedFaceSet& ifs) {
   }
 }
 
-void SceneGraphProcessor::_computeNormalPerCorner(IndexedFaceSet& ifs) {
-  if(ifs.getNormalBinding()==IndexedFaceSet::PB_PER_CORNER) return;
-
+// The contribution of each face to each one of its vertices is
+// computed in parallel, into one vector per corner, and the vectors are
+// then added up in corner order, so that the result does not depend on
+// the number of threads.
+template<class Weight>
+void SceneGraphProcessor::_computeNormalPerVertexWeighted
+(IndexedFaceSet& ifs) {
+  if(ifs.getNormalBinding()==IndexedFaceSet::PB_PER_VERTEX &&
+     ifs.getNormalWeight()==Weight::WEIGHT) {
+    if(ifs.hasChanged(IndexedFaceSet::STALE_NORMAL))
+      _updateNormalPerVertex<Weight>(ifs);
+    return;
+  }
   vector<float>& coord       = ifs.getCoord();
   vector<int>&   coordIndex  = ifs.getCoordIndex();
   vector<float>& normal      = ifs.getNormal();
   vector<int>&   normalIndex = ifs.getNormalIndex();
   ifs.setNormalPerVertex(true);
+  ifs.setNormalWeight(Weight::WEIGHT);
   normal.clear();
   normalIndex.clear();
+  ifs.clearChanged(IndexedFaceSet::STALE_NORMAL);
+  ifs.setChanged(IndexedFaceSet::CHANGED_NORMAL);
+  int nV = (int)(coord.size()/3);
+  int nC = (int)coordIndex.size();
+  normal.insert(normal.end(),coord.size(),0.0f);
+
+  ThreadPool& pool = ThreadPool::getInstance();
+
+  // faces; face iF occupies corners [faceFirst[iF],faceFirst[iF+1]-1)
+  vector<int> faceFirst;
+  faceFirst.push_back(0);
+  for(int i1=0;i1<nC;i1++)
+    if(coordIndex[i1]<0)
+      faceFirst.push_back(i1+1);
+  int nF = (int)faceFirst.size()-1;
+
+  // corner contributions
+  vector<float> cornerNormal(3*nC,0.0f);
+  pool.runRange(nF,4096,[&](int iF0, int iF1) {
+      Vec3f n;
+      float nF[3] = { 0.0f, 0.0f, 0.0f };
+      for(int iF=iF0;iF<iF1;iF++) {
+        int i0 = faceFirst[iF];
+        int i1 = faceFirst[iF+1]-1;
+        if(i1-i0<3) continue;
+        if(Weight::FACE_NORMAL) {
+          _computeFaceNormal(coord,coordIndex,i0,i1,n,true);
+          nF[0] = n[0]; nF[1] = n[1]; nF[2] = n[2];
+        }
+        int iPrev = coordIndex[i1-1];
+        int iV    = coordIndex[i0];
+        for(int i=i0;i<i1;i++) {
+          int iNext = coordIndex[(i+1<i1)?i+1:i0];
+          Weight::corner(&coord[3*iV],&coord[3*iPrev],&coord[3*iNext],
+                         nF,&cornerNormal[3*i]);
+          iPrev = iV; iV = iNext;
+        }
+      }
+    });
+
+  // accumulate
+  for(int i=0;i<nC;i++) {
+    int iV = coordIndex[i];
+    if(iV<0 || iV>=nV) continue;
+    normal[3*iV  ] += cornerNormal[3*i  ];
+    normal[3*iV+1] += cornerNormal[3*i+1];
+    normal[3*iV+2] += cornerNormal[3*i+2];
+  }
 
-  Vec3f pP,p0,pN,vP,vN,n;
-  int iF,i,i0,i1,ip,in,nFC,iN,iVp/*,iV0,iVn*/;
+  // normalize
+  pool.runRange(nV,65536,[&](int iV0, int iV1) {
+      for(int iV=iV0;iV<iV1;iV++) {
+        float* n = &normal[3*iV];
+        float nn = n[0]*n[0]+n[1]*n[1]+n[2]*n[2];
+        if(nn>0.0f) {
+          nn = (float)sqrt(nn);
+          n[0] /= nn; n[1] /= nn; n[2] /= nn;
+        }
+      }
+    });
+}
+
+// Vertices [i0,i1) of the STALE_NORMAL ranges of an IndexedFaceSet;
+// returns the number of vertices marked.
+static int getStaleVertices(IndexedFaceSet& ifs, vector<char>& stale) {
+  int nV = ifs.getNumberOfCoord();
+  int nStale = 0;
+  stale.assign(nV,0);
+  vector<int>& range = ifs.getChanged(IndexedFaceSet::STALE_NORMAL);
+  for(int j=0;j+1<(int)range.size();j+=2)
+    for(int iV=range[j];iV<range[j+1] && iV<nV;iV++)
+      if(stale[iV]==0) {
+        stale[iV] = 1;
+        nStale++;
+      }
+  return nStale;
+}
+
+// Record the runs of marked elements as changed normals.
+static void setChangedNormal(IndexedFaceSet& ifs, vector<char>& mark) {
+  int n = (int)mark.size();
+  for(int i0=0;i0<n;i0++) {
+    if(mark[i0]==0) continue;
+    int i1 = i0+1;
+    while(i1<n && mark[i1]) i1++;
+    ifs.setChanged(IndexedFaceSet::CHANGED_NORMAL,i0,i1);
+    i0 = i1;
+  }
+}
+
+// Recompute the normals of the faces with a vertex in the STALE_NORMAL
+// ranges, as _computeNormalPerFace would.
+void SceneGraphProcessor::_updateNormalPerFace(IndexedFaceSet& ifs) {
+  vector<float>& coord      = ifs.getCoord();
+  vector<int>&   coordIndex = ifs.getCoordIndex();
+  vector<float>& normal     = ifs.getNormal();
+  vector<char>   stale;
+  int nStale = getStaleVertices(ifs,stale);
+  ifs.clearChanged(IndexedFaceSet::STALE_NORMAL);
+  if(nStale==0) return;
+  int  nV = (int)stale.size();
+  int  nF = (int)(normal.size()/3);
+  bool isTriangleMesh = true;
+  // first corner of each face with a stale vertex
+  vector<int> faceFirst(nF,-1);
+  int iF,i,i0,i1,iV;
   for(iF=i0=i1=0;i1<(int)coordIndex.size();i1++) {
     if(coordIndex[i1]<0) {
-      nFC = i1-i0; // number of face corners
-      // n << 0,0,0;
-      n[0]=n[1]=n[2]=0.0f;
-      if(nFC>=3) { // polygon
+      if(i1-i0!=3) isTriangleMesh = false;
+      for(i=i0;i<i1 && iF<nF;i++) {
+        iV = coordIndex[i];
+        if(iV>=0 && iV<nV && stale[iV]) {
+          faceFirst[iF] = i0;
+          break;
+        }
+      }
+      i0=i1+1; iF++;
+    }
+  }
+  Vec3f n;
+  vector<char> changed(nF,0);
+  for(iF=0;iF<nF;iF++) {
+    if((i0=faceFirst[iF])<0) continue;
+    if(isTriangleMesh) {
+      TriangleNormals::compute(coord.data(),&coordIndex[i0],1,
+                               &normal[3*iF],true);
+    } else {
+      for(i1=i0;coordIndex[i1]>=0;i1++);
+      _computeFaceNormal(coord,coordIndex,i0,i1,n,true);
+      normal[3*iF  ] = n[0];
+      normal[3*iF+1] = n[1];
+      normal[3*iF+2] = n[2];
+    }
+    changed[iF] = 1;
+  }
+  setChangedNormal(ifs,changed);
+}
+
+// Recompute the per-vertex normals of the vertices which share a face
+// with a vertex in the STALE_NORMAL ranges. Their accumulators are
+// reset, and the contributions of their incident faces are added again
+// in face order, so that the result is the same as recomputing all
+// the normals with the same weighting. The cost is two passes over
+// coordIndex, plus the face normals of the affected faces only.
+template<class Weight>
+void SceneGraphProcessor::_updateNormalPerVertex(IndexedFaceSet& ifs) {
+  vector<float>& coord      = ifs.getCoord();
+  vector<int>&   coordIndex = ifs.getCoordIndex();
+  vector<float>& normal     = ifs.getNormal();
+  vector<char>   stale;
+  int nStale = getStaleVertices(ifs,stale);
+  ifs.clearChanged(IndexedFaceSet::STALE_NORMAL);
+  if(nStale==0) return;
+  int nV = (int)stale.size();
+  int nC = (int)coordIndex.size();
+  if((int)normal.size()<3*nV) return;
+  // vertices of the faces with a stale vertex
+  vector<char> affected(nV,0);
+  bool isTriangleMesh = true;
+  int i,i0,i1,iV;
+  for(i0=i1=0;i1<nC;i1++) {
+    if(coordIndex[i1]<0) {
+      if(i1-i0!=3) isTriangleMesh = false;
+      for(i=i0;i<i1;i++) {
+        iV = coordIndex[i];
+        if(iV>=0 && iV<nV && stale[iV]) break;
+      }
+      if(i<i1)
+        for(i=i0;i<i1;i++) {
+          iV = coordIndex[i];
+          if(iV>=0 && iV<nV) affected[iV] = 1;
+        }
+      i0=i1+1;
+    }
+  }
+  for(iV=0;iV<nV;iV++)
+    if(affected[iV])
+      normal[3*iV] = normal[3*iV+1] = normal[3*iV+2] = 0.0f;
+
+  // the area weighted normals of triangle meshes are accumulated from
+  // the face normals computed by the SIMD kernel
+  bool triangleKernel =
+    Weight::FACE_NORMAL && !Weight::UNIT_FACE_NORMAL && isTriangleMesh;
+
+  // accumulate the contributions of the faces incident to them
+  Vec3f n;
+  float nF[3] = { 0.0f, 0.0f, 0.0f };
+  float nI[3];
+  for(i0=i1=0;i1<nC;i1++) {
+    if(coordIndex[i1]<0) {
+      for(i=i0;i<i1;i++) {
+        iV = coordIndex[i];
+        if(iV>=0 && iV<nV && affected[iV]) break;
+      }
+      if(i<i1 && i1-i0>=3) {
+        if(triangleKernel) {
+          TriangleNormals::compute(coord.data(),&coordIndex[i0],1,nF,false);
+        } else if(Weight::FACE_NORMAL) {
+          _computeFaceNormal(coord,coordIndex,i0,i1,n,
+                             Weight::UNIT_FACE_NORMAL);
+          nF[0] = n[0]; nF[1] = n[1]; nF[2] = n[2];
+        }
+        int iPrev = coordIndex[i1-1];
+        iV = coordIndex[i0];
         for(i=i0;i<i1;i++) {
-          if((ip=i-1)< i0) ip=i1-1;
-          if((in=i+1)==i1) in=i0  ;
-
-          iVp = coordIndex[ip];
-          // iV0 = coordIndex[i ];
-          // iVn = coordIndex[in];
-
-          // pP << coord[3*iVp  ],coord[3*iVp+1],coord[3*iVp+2];
-          pP[0] = coord[3*iVp  ]; pP[1] = coord[3*iVp+1]; pP[2] = coord[3*iVp+2];
-          // p0 << coord[3*iVp  ],coord[3*iVp+1],coord[3*iVp+2];
-          p0[0] = coord[3*iVp  ]; p0[1] = coord[3*iVp+1]; p0[2] = coord[3*iVp+2];
-          // pN << coord[3*iVp  ],coord[3*iVp+1],coord[3*iVp+2];
-          pN[0] = coord[3*iVp  ]; pN[1] = coord[3*iVp+1]; pN[2] = coord[3*iVp+2];
-          // vP = pP-p0;
-          vP[0] = pP[0]-p0[0]; vP[1] = pP[1]-p0[1]; vP[2] = pP[2]-p0[2];
-          // vN = pN-p0;
-          vN[0] = pN[0]-p0[0]; vN[1] = pN[1]-p0[1]; vN[2] = pN[2]-p0[2];
-
-          // n = vN.cross(vP);
-          n[0] = vN[1]*vP[2]-vN[2]*vP[1];
-          n[1] = vN[2]*vP[0]-vN[0]*vP[2];
-          n[2] = vN[0]*vP[1]-vN[1]*vP[0];
-
-          // n.normalize();
-          float nn = n[0]*n[0]+n[1]*n[1]+n[2]*n[2];
-          if(nn>0.0f) {
-            nn = (float)sqrt(nn);
-            n[0] /= nn; n[1] /= nn; n[2] /= nn;
+          int iNext = coordIndex[(i+1<i1)?i+1:i0];
+          if(iV>=0 && iV<nV && affected[iV]) {
+            Weight::corner(&coord[3*iV],&coord[3*iPrev],&coord[3*iNext],
+                           nF,nI);
+            normal[3*iV  ] += nI[0];
+            normal[3*iV+1] += nI[1];
+            normal[3*iV+2] += nI[2];
           }
+          iPrev = iV; iV = iNext;
+        }
+      }
+      i0=i1+1;
+    }
+  }
 
-          iN = (int)(normal.size()/3);
-          normal.push_back(n[0]);
-          normal.push_back(n[1]);
-          normal.push_back(n[2]);
-          normalIndex.push_back(iN);
+  // normalize
+  for(iV=0;iV<nV;iV++) {
+    if(affected[iV]==0) continue;
+    n[0] = normal[3*iV  ];
+    n[1] = normal[3*iV+1];
+    n[2] = normal[3*iV+2];
+    float nn = n[0]*n[0]+n[1]*n[1]+n[2]*n[2];
+    if(nn>0.0f) {
+      nn = (float)sqrt(nn);
+      n[0] /= nn; n[1] /= nn; n[2] /= nn;
+    }
+    normal[3*iV  ] = n[0];
+    normal[3*iV+1] = n[1];
+    normal[3*iV+2] = n[2];
+  }
+  setChangedNormal(ifs,affected);
+}
 
+void SceneGraphProcessor::_computeNormalPerVertexParallel
+(vector<float>& coord, vector<int>& coordIndex, vector<float>& normal,
+ bool isTriangleMesh) {
+  ThreadPool& pool = ThreadPool::getInstance();
+  int nV = (int)(coord.size()/3);
+
+  // faces; face iF occupies corners [faceFirst[iF],faceFirst[iF+1]-1)
+  vector<int> faceFirst;
+  faceFirst.push_back(0);
+  for(int i1=0;i1<(int)coordIndex.size();i1++)
+    if(coordIndex[i1]<0)
+      faceFirst.push_back(i1+1);
+  int nF = (int)faceFirst.size()-1;
+
+  // face normals
+  vector<float> faceNormal(3*nF);
+  if(isTriangleMesh) {
+    computeTriangleNormals(coord,coordIndex,nF,faceNormal.data(),false);
+  } else {
+    pool.runRange(nF,4096,[&](int iF0, int iF1) {
+        Vec3f n;
+        for(int iF=iF0;iF<iF1;iF++) {
+          _computeFaceNormal(coord,coordIndex,
+                             faceFirst[iF],faceFirst[iF+1]-1,n,false);
+          faceNormal[3*iF  ] = n[0];
+          faceNormal[3*iF+1] = n[1];
+          faceNormal[3*iF+2] = n[2];
         }
-        normalIndex.push_back(-1);
+      });
+  }
 
-      } else /* if(nFC<3) */{ // face with less than 3 vertices
-        // throw exception ?
-        // n << 0,0,0;
-        n[0]=n[1]=n[2]=0.0f;
-        for(i=i0;i<i1;i++) {
-          iN = (int)(normal.size()/3);
-          normal.push_back(n[0]);
-          normal.push_back(n[1]);
-          normal.push_back(n[2]);
-          normalIndex.push_back(iN);
+  // vertex-to-face table; a face is listed once for each of its
+  // corners on the vertex
+  vector< atomic<int> > slot(nV);
+  pool.runRange(nV,65536,[&](int iV0, int iV1) {
+      for(int iV=iV0;iV<iV1;iV++)
+        slot[iV].store(0,memory_order_relaxed);
+    });
+  pool.runRange(nF,4096,[&](int iF0, int iF1) {
+      for(int i=faceFirst[iF0];i<faceFirst[iF1];i++) {
+        int iV = coordIndex[i];
+        if(iV>=0 && iV<nV) slot[iV].fetch_add(1,memory_order_relaxed);
+      }
+    });
+  vector<int> vertexFirst(nV+1);
+  vertexFirst[0] = 0;
+  for(int iV=0;iV<nV;iV++)
+    vertexFirst[iV+1] = vertexFirst[iV]+slot[iV].load(memory_order_relaxed);
+  // filled serially, in face order, so that the faces of each vertex
+  // are sorted without depending on the threads
+  vector<int> next(vertexFirst.begin(),vertexFirst.end()-1);
+  vector<int> vertexFace(vertexFirst[nV]);
+  for(int iF=0;iF<nF;iF++)
+    for(int i=faceFirst[iF];i<faceFirst[iF+1]-1;i++) {
+      int iV = coordIndex[i];
+      if(iV>=0 && iV<nV)
+        vertexFace[next[iV]++] = iF;
+    }
+
+  // accumulate and normalize
+  pool.runRange(nV,4096,[&](int iV0, int iV1) {
+      Vec3f n;
+      for(int iV=iV0;iV<iV1;iV++) {
+        int j0 = vertexFirst[iV];
+        int j1 = vertexFirst[iV+1];
+        n[0] = n[1] = n[2] = 0.0f;
+        for(int j=j0;j<j1;j++) {
+          const float* nF = &faceNormal[3*vertexFace[j]];
+          n[0] = n[0]+nF[0];
+          n[1] = n[1]+nF[1];
+          n[2] = n[2]+nF[2];
+        }
+        float nn = n[0]*n[0]+n[1]*n[1]+n[2]*n[2];
+        if(nn>0.0f) {
+          nn = (float)sqrt(nn);
+          n[0] /= nn; n[1] /= nn; n[2] /= nn;
         }
-        normalIndex.push_back(-1);
+        normal[3*iV  ] = n[0];
+        normal[3*iV+1] = n[1];
+        normal[3*iV+2] = n[2];
       }
+    });
+}
 
-      i0=i1+1; iF++;
+// Per-corner normals which depend on the crease angle of the
+// IndexedFaceSet: around each vertex, the incident faces are visited
+// in corner order, and each one joins the first cluster whose seed
+// face has a normal within the crease angle of its own; otherwise it
+// starts a new cluster, becoming its seed. The clusters depend only on
+// the angles to the seeds, not on those between adjacent faces. Each
+// cluster gets one normal, the normalized sum of the (area weighted)
+// face normals of its faces, shared by all its corners through
+// normalIndex; equal normals of different vertices, as those of the
+// corners of a flat face, are stored only once. With the default
+// crease angle 0 the faces are flat shaded; with a crease angle of at
+// least pi the result is a smooth per-vertex normal shared by all the
+// corners.
+void SceneGraphProcessor::_computeNormalPerCorner(IndexedFaceSet& ifs) {
+  // moving vertices may change the clusters, and the shared normals,
+  // of any vertex; stale normals are recomputed from scratch
+  if(ifs.getNormalBinding()==IndexedFaceSet::PB_PER_CORNER &&
+     ifs.hasChanged(IndexedFaceSet::STALE_NORMAL)==false) return;
+
+  vector<float>& coord       = ifs.getCoord();
+  vector<int>&   coordIndex  = ifs.getCoordIndex();
+  vector<float>& normal      = ifs.getNormal();
+  vector<int>&   normalIndex = ifs.getNormalIndex();
+  ifs.setNormalPerVertex(true);
+  ifs.setNormalWeight(-1);
+  normal.clear();
+  normalIndex.clear();
+  ifs.clearChanged(IndexedFaceSet::STALE_NORMAL);
+  ifs.setChanged(IndexedFaceSet::CHANGED_NORMAL);
+
+  int nV = (int)(coord.size()/3);
+  int nF,iF,i,iV,j,j0,j1,k,nK;
+
+  // faces; face iF occupies corners [faceFirst[iF],faceFirst[iF+1]-1)
+  vector<int> faceFirst;
+  faceFirst.push_back(0);
+  for(i=0;i<(int)coordIndex.size();i++)
+    if(coordIndex[i]<0)
+      faceFirst.push_back(i+1);
+  nF = (int)faceFirst.size()-1;
+  int nC = faceFirst[nF];
+
+  // face normals, and their directions
+  vector<float> faceNormal(3*nF);
+  if(ifs.isTriangleMesh()) {
+    computeTriangleNormals(coord,coordIndex,nF,faceNormal.data(),false);
+  } else {
+    ThreadPool::getInstance().runRange(nF,4096,[&](int iF0, int iF1) {
+        Vec3f n;
+        for(int jF=iF0;jF<iF1;jF++) {
+          _computeFaceNormal(coord,coordIndex,
+                             faceFirst[jF],faceFirst[jF+1]-1,n,false);
+          faceNormal[3*jF  ] = n[0];
+          faceNormal[3*jF+1] = n[1];
+          faceNormal[3*jF+2] = n[2];
+        }
+      });
+  }
+  vector<float> faceUnit(faceNormal);
+  for(iF=0;iF<nF;iF++) {
+    float* n = &faceUnit[3*iF];
+    float nn = n[0]*n[0]+n[1]*n[1]+n[2]*n[2];
+    if(nn>0.0f) {
+      nn = (float)sqrt(nn);
+      n[0] /= nn; n[1] /= nn; n[2] /= nn;
     }
   }
+
+  // corners of each vertex, in increasing order
+  vector<int> cornerFace(nC,-1);
+  for(iF=0;iF<nF;iF++)
+    for(i=faceFirst[iF];i<faceFirst[iF+1]-1;i++)
+      cornerFace[i] = iF;
+  vector<int> vertexFirst(nV+1,0);
+  for(i=0;i<nC;i++)
+    if((iV=coordIndex[i])>=0 && iV<nV)
+      vertexFirst[iV+1]++;
+  for(iV=0;iV<nV;iV++)
+    vertexFirst[iV+1] += vertexFirst[iV];
+  vector<int> vertexCorner(vertexFirst[nV]);
+  vector<int> next(vertexFirst.begin(),vertexFirst.end()-1);
+  for(i=0;i<nC;i++)
+    if((iV=coordIndex[i])>=0 && iV<nV)
+      vertexCorner[next[iV]++] = i;
+  vector<int>().swap(next);
+
+  float creaseAngle = ifs.getCreaseangle();
+  if(creaseAngle<0.0f) creaseAngle = 0.0f;
+  float cosCrease = (creaseAngle>=3.14159265f)?-2.0f:(float)cos(creaseAngle);
+
+  // normalIndex keeps the -1 separators; corners with invalid vertex
+  // indices get a zero normal, added when needed
+  normalIndex.assign(nC,-1);
+  int iZero = -1;
+  vector<int>   seed;    // first face of each cluster
+  vector<Vec3f> sum;     // sum of the face normals of each cluster
+  vector<int>   cluster; // cluster of each corner of the vertex
+  for(iV=0;iV<nV;iV++) {
+    j0 = vertexFirst[iV];
+    j1 = vertexFirst[iV+1];
+    seed.clear();
+    sum.clear();
+    cluster.clear();
+    for(j=j0;j<j1;j++) {
+      iF = cornerFace[vertexCorner[j]];
+      const float* u = &faceUnit[3*iF];
+      bool isZero = (u[0]==0.0f && u[1]==0.0f && u[2]==0.0f);
+      nK = (int)seed.size();
+      for(k=0;k<nK;k++) {
+        if(isZero) break; // degenerate faces join the first cluster
+        const float* v = &faceUnit[3*seed[k]];
+        if(u[0]*v[0]+u[1]*v[1]+u[2]*v[2]>=cosCrease) break;
+      }
+      if(k==nK) {
+        seed.push_back(iF);
+        sum.push_back(Vec3f());
+      }
+      const float* n = &faceNormal[3*iF];
+      sum[k][0] += n[0]; sum[k][1] += n[1]; sum[k][2] += n[2];
+      cluster.push_back(k);
+    }
+    int iN = (int)(normal.size()/3);
+    nK = (int)sum.size();
+    for(k=0;k<nK;k++) {
+      Vec3f& n = sum[k];
+      float nn = n[0]*n[0]+n[1]*n[1]+n[2]*n[2];
+      if(nn>0.0f) {
+        nn = (float)sqrt(nn);
+        n[0] /= nn; n[1] /= nn; n[2] /= nn;
+      }
+      normal.push_back(n[0]);
+      normal.push_back(n[1]);
+      normal.push_back(n[2]);
+    }
+    for(j=j0;j<j1;j++)
+      normalIndex[vertexCorner[j]] = iN+cluster[j-j0];
+  }
+  for(i=0;i<nC;i++) {
+    if(coordIndex[i]>=0 && normalIndex[i]<0) {
+      if(iZero<0) {
+        iZero = (int)(normal.size()/3);
+        normal.insert(normal.end(),3,0.0f);
+      }
+      normalIndex[i] = iZero;
+    }
+  }
+
+  // share equal normals
+  VertexWeld weld;
+  weld.apply(normal,normalIndex);
 }
 
 void SceneGraphProcessor::bboxAdd
@@ -375,6 +989,8 @@ void SceneGraphProcessor::bboxAdd
   colorIndex.clear();
   ils->setColorPerVertex(true);
 
+  // the box of the scene without the old BOUNDING-BOX coordinates
+  shape->invalidateBBox();
   _wrl.updateBBox();
   Vec3f& center = _wrl.getBBoxCenter();
   Vec3f& size   = _wrl.getBBoxSize();
@@ -476,6 +1092,8 @@ void SceneGraphProcessor::bboxAdd
     }
 
   }
+
+  shape->invalidateBBox();
 }
 
 void SceneGraphProcessor::bboxRemove() {
@@ -484,8 +1102,43 @@ void SceneGraphProcessor::bboxRemove() {
   for(i=children.begin();i!=children.end();i++)
     if((*i)->nameEquals("BOUNDING-BOX"))
       break;
-  if(i!=children.end())
+  if(i!=children.end()) {
     children.erase(i);
+    _wrl.invalidateBBox();
+  }
+}
+
+void SceneGraphProcessor::weldVertices(float epsilon) {
+  SceneGraphTraversal traversal(_wrl);
+  traversal.start();
+  Node* node;
+  while((node=traversal.next())!=(Node*)0) {
+    if(node->isShape()) {
+      Shape* shape = (Shape*)node;
+      node = shape->getGeometry();
+      if(node!=(Node*)0 && node->isIndexedFaceSet()) {
+        IndexedFaceSet& ifs = *((IndexedFaceSet*)node);
+        _weldVertices(ifs,epsilon);
+      }
+    }
+  }
+}
+
+void SceneGraphProcessor::_weldVertices(IndexedFaceSet& ifs, float epsilon) {
+  vector<float>& coord      = ifs.getCoord();
+  vector<int>&   coordIndex = ifs.getCoordIndex();
+  VertexWeld weld(epsilon);
+  weld.weld(coord);
+  if(weld.getNumberOfWeldedVertices()==weld.getNumberOfVertices()) return;
+  // properties bound per vertex follow the first vertex of each group
+  if(ifs.getNormalBinding()==IndexedFaceSet::PB_PER_VERTEX)
+    weld.compact(ifs.getNormal(),3);
+  if(ifs.getColorBinding()==IndexedFaceSet::PB_PER_VERTEX)
+    weld.compact(ifs.getColor(),3);
+  if(ifs.getTexCoordBinding()==IndexedFaceSet::PB_PER_VERTEX)
+    weld.compact(ifs.getTexCoord(),2);
+  weld.compact(coord,3);
+  weld.remapIndex(coordIndex);
 }
 
 void SceneGraphProcessor::edgesAdd() {
@@ -549,29 +1202,17 @@ void SceneGraphProcessor::edgesAdd() {
         coordIls.insert(coordIls.end(),
                         coordIfs.begin(),coordIfs.end());
 
-        int i,i0,i1,nV,iV,iV0,iV1,iF;
-        nV = static_cast<int>(coordIfs.size()/3);
-        for(iV=0;iV<nV;iV++) {
-          coordIls.push_back(coordIfs[3*iV  ]);
-          coordIls.push_back(coordIfs[3*iV+1]);
-          coordIls.push_back(coordIfs[3*iV+2]);
-        }
-
-        for(iF=i0=i1=0;i1<(int)coordIndexIfs.size();i1++) {
-          if(coordIndexIfs[i1]<0) {
-            iV0 = coordIndexIfs[i1-1];
-            for(i=i0;i<i1;i++) {
-              iV1 = coordIndexIfs[i];
-              coordIndexIls.push_back(iV0);
-              coordIndexIls.push_back(iV1);
-              coordIndexIls.push_back(-1);
-              iV0 = iV1;
-            }
-            iF++; i0 = i1+1;
-          }
+        // each edge shared by several faces is added only once
+        int nV = static_cast<int>(coordIfs.size()/3);
+        Edges edges(nV,coordIndexIfs);
+        int iE,nE = edges.getNumberOfEdges();
+        coordIndexIls.reserve(3*nE);
+        for(iE=0;iE<nE;iE++) {
+          coordIndexIls.push_back(edges.getVertex0(iE));
+          coordIndexIls.push_back(edges.getVertex1(iE));
+          coordIndexIls.push_back(-1);
         }
-
-
+        shape->invalidateBBox();
       }
     }
   }
@@ -594,6 +1235,7 @@ void SceneGraphProcessor::edgesRemove() {
             break;
         if(i!=children.end()) {
           children.erase(i);
+          group->invalidateBBox();
           i=children.begin();
         }
       } while(i!=children.end());
@@ -887,8 +1529,10 @@ void SceneGraphProcessor::removeSceneGraphChild(const string& name) {
   for(i=children.begin();i!=children.end();i++)
     if((*i)->nameEquals(name))
       break;
-  if(i!=children.end())
+  if(i!=children.end()) {
     children.erase(i);
+    _wrl.invalidateBBox();
+  }
 }
 
 void SceneGraphProcessor::pointsRemove() {
@@ -45,19 +45,39 @@ class SceneGraphProcessor {
 
 public:
 
+  // weighting of the face normals accumulated into the vertex normals
+  // by computeNormalPerVertex: by face area, by the interior angle of
+  // the face at the vertex, or by the reciprocals of the squared
+  // lengths of the two face edges incident to the vertex (N. Max,
+  // "Weights for Computing Vertex Normals from Facet Normals", 1999)
+  enum NormalWeight {
+    NORMAL_WEIGHT_AREA,
+    NORMAL_WEIGHT_ANGLE,
+    NORMAL_WEIGHT_EDGE
+  };
+
   SceneGraphProcessor(SceneGraph& wrl);
   ~SceneGraphProcessor();
 
   void normalClear();
   void normalInvert();
   void computeNormalPerFace();
-  void computeNormalPerVertex();
+  // per-vertex normals computed with the same weighting are only
+  // updated in the STALE_NORMAL ranges; other normals are recomputed
+  void computeNormalPerVertex(NormalWeight weight=NORMAL_WEIGHT_AREA);
+  // recomputes the normals of the IndexedFaceSets which have per-vertex
+  // normals, leaving those with other bindings unchanged
+  void recomputeNormalPerVertex(NormalWeight weight);
   void computeNormalPerCorner();
 
   void bboxAdd(int depth=0, float scale=1.0f, bool isCube=true);
   void bboxRemove();
   bool hasBBox();
 
+  // merge the vertices of each IndexedFaceSet closer than epsilon;
+  // epsilon==0 merges only equal vertices
+  void weldVertices(float epsilon=0.0f);
+
   void edgesAdd();
   void edgesRemove();
   bool hasEdges();
@@ -100,6 +120,23 @@ private:
   static void _computeNormalPerVertex(IndexedFaceSet& ifs);
   static void _computeNormalPerCorner(IndexedFaceSet& ifs);
 
+  static void _weldVertices(IndexedFaceSet& ifs, float epsilon);
+
+  template<class Weight>
+  static void _computeNormalPerVertexWeighted(IndexedFaceSet& ifs);
+  template<class Weight>
+  static void _recomputeNormalPerVertex(IndexedFaceSet& ifs);
+
+  // incremental updates of the normals of the vertices in the
+  // IndexedFaceSet::STALE_NORMAL ranges, and of their incident faces
+  static void _updateNormalPerFace(IndexedFaceSet& ifs);
+  template<class Weight>
+  static void _updateNormalPerVertex(IndexedFaceSet& ifs);
+
+  static void _computeNormalPerVertexParallel
+              (vector<float>& coord, vector<int>& coordIndex,
+               vector<float>& normal, bool isTriangleMesh);
+
   static void _computeFaceNormal
               (vector<float>& coord, vector<int>&   coordIndex,
                int i0, int i1, Vec3f& n, bool normalize);
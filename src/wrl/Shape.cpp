@@ -33,8 +33,12 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <iostream>
+#include <float.h>
 #include "Shape.hpp"
 #include "Appearance.hpp"
+#include "IndexedFaceSet.hpp"
+#include "IndexedLineSet.hpp"
+#include "util/MinMax.hpp"
 
 Shape::Shape():
   _appearance((Node*)0),
@@ -108,6 +112,29 @@ void Shape::setAppearance(Node* node) {
 void Shape::setGeometry(Node* node) {
   node->setParent(this);
   _geometry = node;
+  invalidateBBox();
+}
+
+bool Shape::getBBox(Vec3f& min, Vec3f& max) {
+  if(_bboxValid==false) {
+    _bboxMin.x = _bboxMin.y = _bboxMin.z =  FLT_MAX;
+    _bboxMax.x = _bboxMax.y = _bboxMax.z = -FLT_MAX;
+    vector<float>* coord = (vector<float>*)0;
+    if(hasGeometryIndexedFaceSet())
+      coord = &(((IndexedFaceSet*)_geometry)->getCoord());
+    else if(hasGeometryIndexedLineSet())
+      coord = &(((IndexedLineSet*)_geometry)->getCoord());
+    if(coord!=(vector<float>*)0) {
+      float min[3],max[3];
+      MinMax::compute(coord->data(),(int)(coord->size()/3),3,min,max);
+      _bboxMin.x = min[0]; _bboxMin.y = min[1]; _bboxMin.z = min[2];
+      _bboxMax.x = max[0]; _bboxMax.y = max[1]; _bboxMax.z = max[2];
+    }
+    _bboxValid = true;
+  }
+  min = _bboxMin;
+  max = _bboxMax;
+  return (min.x<=max.x);
 }
 
 void Shape::printInfo(string indent) {
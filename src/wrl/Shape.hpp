@@ -45,6 +45,8 @@ private:
 
   Node* _appearance;
   Node* _geometry;
+  Vec3f _bboxMin;
+  Vec3f _bboxMax;
 
 public:
   
@@ -64,6 +66,10 @@ public:
   bool            hasGeometryIndexedFaceSet();
   bool            hasGeometryIndexedLineSet();
   bool            hasGeometryUnsupported();
+
+  // bounding box of the coordinates of the geometry, computed once
+  // and cached until invalidateBBox() is called; false if empty
+  bool            getBBox(Vec3f& min, Vec3f& max);
   
   virtual bool    isShape() const { return    true; }
   virtual string  getType() const { return "Shape"; }
@@ -54,18 +54,42 @@ Vec3f&    Transform::getScale()                      {  return            _scale
 Rotation& Transform::getScaleOrientation()           {  return _scaleOrientation; }
 Vec3f&    Transform::getTranslation()                {  return      _translation; }
 
-void Transform::setCenter(Vec3f& value)              {           _center = value; }
-void Transform::setRotation(Rotation& value)         {         _rotation = value; }
-void Transform::setScale(Vec3f& value)               {            _scale = value; }
-void Transform::setScaleOrientation(Rotation& value) { _scaleOrientation = value; }
-void Transform::setTranslation(Vec3f& value)         {      _translation = value; }
+// the bounding box of a Transform is in the coordinates of its
+// children, but the box of its parent depends on the fields
+
+void Transform::setCenter(Vec3f& value) {
+  _center = value;
+  invalidateBBox();
+}
+
+void Transform::setRotation(Rotation& value) {
+  _rotation = value;
+  invalidateBBox();
+}
+
+void Transform::setScale(Vec3f& value) {
+  _scale = value;
+  invalidateBBox();
+}
+
+void Transform::setScaleOrientation(Rotation& value) {
+  _scaleOrientation = value;
+  invalidateBBox();
+}
+
+void Transform::setTranslation(Vec3f& value) {
+  _translation = value;
+  invalidateBBox();
+}
 
 void Transform::setRotation(Vec4f& value) {
   _rotation = value;
+  invalidateBBox();
 }
 
 void Transform::setScaleOrientation(Vec4f& value) {
   _scaleOrientation = value;
+  invalidateBBox();
 }
 
 void Transform::getMatrix(float* M /*[16]*/) {